@@ -0,0 +1,78 @@
+// Cuenta las reservas de memoria del bucle de entrenamiento en régimen estable.
+// Reemplaza el operator new global, ejecuta unos pasos de calentamiento y luego
+// verifica que train_step no reserva nada. Devuelve 1 si encuentra reservas.
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "../include/common.h"
+#include "../include/network.h"
+
+static std::atomic<size_t> allocation_count{0};
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) return p;
+    throw std::bad_alloc();
+}
+
+// Sin inlining: GCC vería free() sobre punteros de operator new y avisaría
+// (-Wmismatched-new-delete) aunque la pareja malloc/free sea correcta
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+
+// Las formas de array y con tamaño delegan en las anteriores, así cada reserva
+// se libera por la función que corresponde a la que la hizo
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t align) { return operator new(size, align); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept { operator delete(p, align); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::align_val_t align) noexcept { operator delete(p, align); }
+void operator delete[](void* p, std::size_t, std::align_val_t align) noexcept { operator delete(p, align); }
+
+template <typename T>
+size_t steady_state_allocations(size_t batch_size, size_t steps) {
+    const size_t samples = 256;
+    Matrix<T> inputs = initialize_matrix<T>(samples, INPUT_SIZE);
+    std::vector<int> labels(samples);
+    for (size_t i = 0; i < samples; ++i) labels[i] = static_cast<int>(i % OUTPUT_SIZE);
+
+    NeuralNetwork<T> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, static_cast<T>(0.01));
+    nn.reserve_batch(batch_size);
+
+    // Lotes completos y un lote final más corto, como en una época real
+    auto run_epoch = [&] {
+        for (size_t start = 0; start < samples; start += batch_size) {
+            const size_t batch = std::min(batch_size, samples - start);
+            nn.train_step(inputs[start].data(), &labels[start], batch);
+        }
+    };
+    run_epoch(); // Calentamiento: buffers de empaquetado del GEMM y tabla de kernels
+
+    const size_t before = allocation_count.load();
+    for (size_t s = 0; s < steps; ++s) run_epoch();
+    return allocation_count.load() - before;
+}
+
+int main() {
+    size_t total = 0;
+    for (size_t batch_size : {1, 32, 100}) {
+        const size_t d = steady_state_allocations<double>(batch_size, 3);
+        const size_t f = steady_state_allocations<float>(batch_size, 3);
+        std::cout << "batch " << batch_size << ": reservas en régimen estable double=" << d
+                  << " float=" << f << std::endl;
+        total += d + f;
+    }
+    std::cout << (total == 0 ? "OK: el bucle de entrenamiento no reserva memoria" :
+                               "ERROR: el bucle de entrenamiento reserva memoria") << std::endl;
+    return total == 0 ? 0 : 1;
+}
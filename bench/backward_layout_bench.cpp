@@ -0,0 +1,128 @@
+// Compara el tiempo de retropropagación por muestra con pesos solo row-major
+// y con la disposición dual (W y W^T). El tiempo de backward se obtiene como
+// el de un paso de entrenamiento de una muestra menos el de su forward.
+// También mide pasos por lotes, que no leen W^T: Dual no debe ser más lento que
+// row-major, y tras ellos los pasos por muestra deben usar una W^T al día.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include "../include/common.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+template <typename T>
+double backward_seconds(const std::vector<int>& architecture, WeightLayout layout) {
+    const size_t samples = 512;
+    Matrix<T> inputs = initialize_matrix<T>(samples, architecture.front());
+    std::vector<int> labels(samples);
+    for (size_t i = 0; i < samples; ++i) labels[i] = static_cast<int>(i % architecture.back());
+
+    NeuralNetwork<T> nn(architecture, static_cast<T>(0.001));
+    nn.set_weight_layout(layout);
+
+    size_t next = 0;
+    const double step = time_operation([&] {
+        nn.train_step(inputs[next].data(), &labels[next], 1);
+        next = (next + 1) % samples;
+    });
+    const double forward = time_operation([&] {
+        nn.predict(inputs[next]);
+        next = (next + 1) % samples;
+    });
+    return step - forward;
+}
+
+// Segundos por paso de entrenamiento con lotes de batch muestras
+template <typename T>
+double batch_step_seconds(const std::vector<int>& architecture, WeightLayout layout, size_t batch) {
+    const size_t samples = 4 * batch;
+    Matrix<T> inputs = initialize_matrix<T>(samples, architecture.front());
+    std::vector<int> labels(samples);
+    for (size_t i = 0; i < samples; ++i) labels[i] = static_cast<int>(i % architecture.back());
+
+    NeuralNetwork<T> nn(architecture, static_cast<T>(0.001));
+    nn.set_weight_layout(layout);
+    nn.reserve_batch(batch);
+
+    size_t next = 0;
+    return time_operation([&] {
+        nn.train_step(inputs[next].data(), &labels[next], batch);
+        next = (next + batch) % samples;
+    });
+}
+
+// Pasos por lotes y luego por muestra en Dual deben dar los mismos pesos que en row-major
+template <typename T>
+bool dual_matches_row_major(const std::vector<int>& architecture) {
+    const size_t samples = 64;
+    Matrix<T> inputs = initialize_matrix<T>(samples, architecture.front());
+    std::vector<int> labels(samples);
+    for (size_t i = 0; i < samples; ++i) labels[i] = static_cast<int>(i % architecture.back());
+
+    NeuralNetwork<T> dual(architecture, static_cast<T>(0.01));
+    dual.set_weight_layout(WeightLayout::Dual);
+    NeuralNetwork<T> row_major = dual;
+    row_major.set_weight_layout(WeightLayout::RowMajor);
+    for (NeuralNetwork<T>* nn : {&dual, &row_major}) {
+        nn->train_step(inputs.data(), labels.data(), samples);
+        for (size_t i = 0; i < samples; ++i) nn->train_step(inputs[i].data(), &labels[i], 1);
+    }
+
+    for (size_t l = 0; l < dual.get_weights().size(); ++l) {
+        const Matrix<T>& a = dual.get_weights()[l];
+        const Matrix<T>& b = row_major.get_weights()[l];
+        for (size_t k = 0; k < a.size(); ++k) {
+            if (std::abs(a.data()[k] - b.data()[k]) > static_cast<T>(1e-4)) return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool run_all(const char* type_name) {
+    const std::vector<std::vector<int>> architectures = {
+            {INPUT_SIZE, 128, OUTPUT_SIZE},
+            {INPUT_SIZE, 512, 256, OUTPUT_SIZE},
+            {INPUT_SIZE, 1024, 1024, OUTPUT_SIZE},
+    };
+    std::cout << "== " << type_name << " ==" << std::endl;
+    for (const auto& architecture : architectures) {
+        std::string name;
+        for (int n : architecture) name += (name.empty() ? "" : "-") + std::to_string(n);
+        const double row_major = backward_seconds<T>(architecture, WeightLayout::RowMajor);
+        const double dual = backward_seconds<T>(architecture, WeightLayout::Dual);
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+                  << "  backward/muestra row-major " << std::setw(8) << row_major * 1e6 << " us"
+                  << "  dual " << std::setw(8) << dual * 1e6 << " us"
+                  << "  (dual/row-major " << std::setprecision(2) << dual / row_major << ")" << std::endl;
+    }
+
+    const size_t batch = 64;
+    bool ok = true;
+    for (const auto& architecture : architectures) {
+        std::string name;
+        for (int n : architecture) name += (name.empty() ? "" : "-") + std::to_string(n);
+        const double row_major = batch_step_seconds<T>(architecture, WeightLayout::RowMajor, batch);
+        const double dual = batch_step_seconds<T>(architecture, WeightLayout::Dual, batch);
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+                  << "  paso/lote de " << batch << " row-major " << std::setw(8) << row_major * 1e6 << " us"
+                  << "  dual " << std::setw(8) << dual * 1e6 << " us"
+                  << "  (dual/row-major " << std::setprecision(2) << dual / row_major << ")" << std::endl;
+        // Mismo trabajo en ambos modos: solo se admite el ruido de la medida
+        if (dual > 1.2 * row_major) {
+            std::cerr << "Error: con lotes, Dual es más lento que row-major en " << name << std::endl;
+            ok = false;
+        }
+        if (!dual_matches_row_major<T>(architecture)) {
+            std::cerr << "Error: tras pasos por lotes, Dual diverge de row-major en " << name << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    const bool ok = run_all<double>("double") & run_all<float>("float");
+    return ok ? 0 : 1;
+}
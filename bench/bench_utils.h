@@ -0,0 +1,32 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <chrono>
+#include <functional>
+
+/**
+ * Mide el tiempo medio de una operación repitiéndola hasta superar un mínimo.
+ * @param op Operación a medir.
+ * @param min_seconds Tiempo mínimo total de medición.
+ * @return Segundos por repetición.
+ */
+inline double time_operation(const std::function<void()>& op, double min_seconds = 0.2) {
+    using clock = std::chrono::steady_clock;
+    op(); // Calentamiento
+    size_t reps = 0;
+    const auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+        op();
+        ++reps;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    return elapsed / reps;
+}
+
+// Segundos transcurridos desde un instante dado
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif // BENCH_UTILS_H
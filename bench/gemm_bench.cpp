@@ -0,0 +1,68 @@
+#include <iostream>
+#include <iomanip>
+#include "../include/common.h"
+#include "bench_utils.h"
+
+// Triple bucle de referencia: C = op(A) * op(B)
+template <typename T>
+void naive_gemm(bool trans_a, bool trans_b, size_t m, size_t n, size_t k,
+                const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc) {
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            T sum = 0;
+            for (size_t p = 0; p < k; ++p) {
+                sum += (trans_a ? a[p * lda + i] : a[i * lda + p]) * (trans_b ? b[j * ldb + p] : b[p * ldb + j]);
+            }
+            c[i * ldc + j] = sum;
+        }
+    }
+}
+
+template <typename T>
+void run_case(const char* name, bool trans_a, bool trans_b, size_t m, size_t n, size_t k) {
+    const Matrix<T> a = trans_a ? initialize_matrix<T>(k, m) : initialize_matrix<T>(m, k);
+    const Matrix<T> b = trans_b ? initialize_matrix<T>(n, k) : initialize_matrix<T>(k, n);
+    Matrix<T> c_naive(m, n), c_blocked(m, n);
+
+    const double t_naive = time_operation([&] {
+        naive_gemm(trans_a, trans_b, m, n, k, a.data(), a.cols(), b.data(), b.cols(), c_naive.data(), n);
+    });
+    const double t_blocked = time_operation([&] {
+        gemm(trans_a, trans_b, m, n, k, static_cast<T>(1), a.data(), a.cols(), b.data(), b.cols(),
+             static_cast<T>(0), c_blocked.data(), n);
+    });
+
+    T max_error = 0;
+    for (size_t i = 0; i < c_naive.size(); ++i) {
+        max_error = std::max(max_error, std::abs(c_naive.data()[i] - c_blocked.data()[i]));
+    }
+
+    const double flops = 2.0 * m * n * k;
+    std::cout << std::left << std::setw(34) << name
+              << std::right << std::setw(5) << m << "x" << std::setw(4) << n << "x" << std::setw(4) << k
+              << "  naive " << std::fixed << std::setprecision(2) << std::setw(7) << flops / t_naive * 1e-9
+              << "  gemm " << std::setw(7) << flops / t_blocked * 1e-9 << " GFLOP/s"
+              << "  x" << std::setw(5) << t_naive / t_blocked
+              << "  err " << std::scientific << std::setprecision(1) << static_cast<double>(max_error)
+              << std::defaultfloat << std::endl;
+}
+
+template <typename T>
+void run_all(const char* type_name) {
+    std::cout << "== " << type_name << " ==" << std::endl;
+    for (size_t batch : {32, 128, 512}) {
+        // Forward: Z = X * W^T para las capas 784x128 y 128x10
+        run_case<T>("forward 784->128 (X * W^T)", false, true, batch, 128, INPUT_SIZE);
+        run_case<T>("forward 128->10  (X * W^T)", false, true, batch, OUTPUT_SIZE, 128);
+        // Backward: dW = delta^T * A_prev y delta_prev = delta * W
+        run_case<T>("grad W 784->128  (D^T * X)", true, false, 128, INPUT_SIZE, batch);
+        run_case<T>("grad W 128->10   (D^T * A)", true, false, OUTPUT_SIZE, 128, batch);
+        run_case<T>("delta  128->10   (D * W)", false, false, batch, 128, OUTPUT_SIZE);
+    }
+}
+
+int main() {
+    run_all<double>("double");
+    run_all<float>("float");
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Carga de MNIST comprimido con gzip (.idx3-ubyte.gz): Dataset en float y en bytes
+// descomprimiendo al vuelo, frente a descomprimir primero el archivo entero y
+// normalizarlo después (sin solapar) y frente a los archivos sin comprimir.
+// Comprueba que las imágenes coinciden con las de los archivos sin comprimir.
+// Los .gz que no existan en directorio_gz se generan con zlib en un directorio
+// temporal a partir de los archivos sin comprimir.
+// Uso: gzip_bench [directorio_gz] [directorio_sin_comprimir] [hilos]
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <cstring>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "bench_utils.h"
+
+#ifdef REDNEURONAL_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    // Comprime src en dst con gzip (nivel por defecto de zlib)
+    bool compress_file(const std::string& src, const std::string& dst) {
+#ifdef REDNEURONAL_HAS_ZLIB
+        std::ifstream in(src, std::ios::binary);
+        if (!in) return false;
+        gzFile out = gzopen(dst.c_str(), "wb");
+        if (!out) return false;
+        std::vector<char> buffer(std::size_t{1} << 20);
+        bool ok = true;
+        while (ok && (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0)) {
+            ok = gzwrite(out, buffer.data(), static_cast<unsigned>(in.gcount())) == in.gcount();
+        }
+        return gzclose(out) == Z_OK && ok;
+#else
+        (void)src;
+        (void)dst;
+        return false;
+#endif
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::string gz_dir = argc > 1 ? argv[1] : "../data";
+    const std::string raw_dir = argc > 2 ? argv[2] : "../data";
+    const size_t threads = argc > 3 ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+    const std::string names[] = {"/train-images.idx3-ubyte", "/train-labels.idx1-ubyte", "/t10k-images.idx3-ubyte",
+                                 "/t10k-labels.idx1-ubyte"};
+    if (!GzipReader::available()) {
+        std::cerr << "Compilado sin zlib: no se pueden leer archivos .gz" << std::endl;
+        return 1;
+    }
+
+    std::string gz[4], raw[4];
+    std::vector<std::string> generated;
+    for (int i = 0; i < 4; ++i) {
+        gz[i] = gz_dir + names[i] + ".gz";
+        raw[i] = raw_dir + names[i];
+        if (!std::filesystem::exists(raw[i])) {
+            std::cerr << "No se encuentra " << raw[i] << std::endl
+                      << "Uso: gzip_bench [directorio_gz] [directorio_sin_comprimir] [hilos]" << std::endl;
+            return 1;
+        }
+        if (!std::filesystem::exists(gz[i])) {
+            gz[i] = (std::filesystem::temp_directory_path() / ("gzip_bench_" + names[i].substr(1) + ".gz")).string();
+            if (!compress_file(raw[i], gz[i])) {
+                std::cerr << "Error: no se pudo generar " << gz[i] << std::endl;
+                return 1;
+            }
+            generated.push_back(gz[i]);
+        }
+    }
+    if (!generated.empty()) {
+        std::cout << "Generados " << generated.size() << " archivos .gz en "
+                  << std::filesystem::temp_directory_path().string() << std::endl;
+    }
+    try {
+        ThreadPool pool(threads);
+        const double t_raw = time_operation([&] { Dataset<float> d(raw[0], raw[1], raw[2], raw[3], &pool); });
+        const double t_gz = time_operation([&] { Dataset<float> d(gz[0], gz[1], gz[2], gz[3], &pool); });
+        const double t_gz_bytes = time_operation([&] { Dataset<uint8_t> d(gz[0], gz[1], gz[2], gz[3]); });
+        // Referencia sin solapar: descomprimir cada archivo entero y normalizarlo después
+        const double t_serial = time_operation([&] {
+            for (int i : {0, 2}) {
+                const IdxFile file(gz[i]);
+                Matrix<float> images(file.shape()[0], file.size() / file.shape()[0]);
+                parallel_for(&pool, 0, file.size(), size_t{1} << 16, [&](size_t first, size_t last) {
+                    Kernels::convert_u8(file.bytes().data() + first, images.data() + first, last - first,
+                                        static_cast<float>(PIXEL_SCALE));
+                });
+            }
+            for (int i : {1, 3}) Mnist::labels_from(IdxFile(gz[i]));
+        });
+
+        const Dataset<float> from_raw(raw[0], raw[1], raw[2], raw[3], &pool);
+        const Dataset<float> from_gz(gz[0], gz[1], gz[2], gz[3], &pool);
+        const auto& a = from_raw.get_training_images();
+        const auto& b = from_gz.get_training_images();
+        const bool same = a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0 &&
+                          from_raw.get_training_labels() == from_gz.get_training_labels() &&
+                          from_raw.get_test_labels() == from_gz.get_test_labels();
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Dataset<float> sin comprimir:     " << t_raw * 1e3 << " ms" << std::endl
+                  << "Dataset<float> .gz solapado:      " << t_gz * 1e3 << " ms" << std::endl
+                  << "Dataset<uint8_t> .gz directo:     " << t_gz_bytes * 1e3 << " ms" << std::endl
+                  << "IdxFile .gz y normalizar después: " << t_serial * 1e3 << " ms" << std::endl
+                  << "Imágenes y etiquetas " << (same ? "idénticas" : "DISTINTAS") << " a las de los archivos sin comprimir"
+                  << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        for (const auto& path : generated) std::filesystem::remove(path);
+        return 1;
+    }
+    for (const auto& path : generated) std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Convergencia frente a tiempo real: entrenamiento serie (SGD por muestra) contra
+// el modo Hogwild asíncrono con N hilos sobre MNIST. Tras cada época muestra el
+// tiempo acumulado, la pérdida de entrenamiento y la precisión en el conjunto de prueba.
+// Antes comprueba que Hogwild rechaza QAT y Dual con lotes, que no son seguros sin bloqueos.
+// Uso: hogwild_bench [hilos] [épocas] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <string>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+// Entrena epochs épocas e imprime la curva pérdida/precisión frente al tiempo
+static void run(const char* name, const Dataset<float>& mnist, size_t threads, int epochs, ParallelMode mode) {
+    NeuralNetwork<float> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.01f);
+    nn.set_parallel_mode(mode);
+
+    double elapsed = 0.0;
+    std::cout << name << " (" << threads << " hilos)" << std::endl;
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        const auto start = std::chrono::steady_clock::now();
+        const float loss = nn.train_epoch(mnist.get_training_images(), mnist.get_training_labels(), 1, threads);
+        elapsed += seconds_since(start);
+
+        const double accuracy = nn.evaluate(mnist.get_test_images(), mnist.get_test_labels());
+        std::cout << "  época " << epoch << std::fixed << std::setprecision(2) << std::setw(9) << elapsed
+                  << " s  pérdida " << std::setprecision(4) << loss
+                  << "  precisión " << std::setprecision(2) << accuracy << "%" << std::endl;
+    }
+}
+
+// true si train_epoch en Hogwild rechaza la configuración que deja configure
+template <typename Configure>
+static bool hogwild_rejects(size_t batch_size, Configure configure) {
+    Matrix<float> inputs = initialize_matrix<float>(64, INPUT_SIZE);
+    std::vector<int> labels(64, 0);
+    NeuralNetwork<float> nn({INPUT_SIZE, 32, OUTPUT_SIZE}, 0.01f);
+    nn.set_parallel_mode(ParallelMode::Hogwild);
+    configure(nn, inputs);
+    try {
+        nn.train_epoch(inputs, labels, batch_size, 2);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t threads = argc > 1 ? std::stoul(argv[1]) : hardware;
+    const int epochs = argc > 2 ? std::stoi(argv[2]) : 3;
+    const std::string dir = argc > 3 ? argv[3] : "../data";
+
+    const auto dual = [](NeuralNetwork<float>& nn, const Matrix<float>&) { nn.set_weight_layout(WeightLayout::Dual); };
+    const auto qat = [](NeuralNetwork<float>& nn, const Matrix<float>& x) { nn.enable_quantization_aware(x); };
+    if (!hogwild_rejects(8, dual) || !hogwild_rejects(1, qat) || hogwild_rejects(1, dual)) {
+        std::cerr << "Error: Hogwild no valida las combinaciones con Dual o QAT" << std::endl;
+        return 1;
+    }
+
+    try {
+        Dataset<float> mnist(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                             dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        std::cout << "Núcleos disponibles: " << hardware << std::endl;
+        run("Serie", mnist, 1, epochs, ParallelMode::Synchronous);
+        run("Hogwild", mnist, threads, epochs, ParallelMode::Hogwild);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Decodificación de archivos IDX de cada tipo (int8, int16, int32, float, double):
+// escribe un archivo sintético por tipo, lo decodifica con cada variante de los
+// kernels y con el pool de hilos, y comprueba que los valores coinciden con los escritos.
+// Uso: idx_bench [millones_de_elementos] [hilos]
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <cstring>
+#include "../include/idx_file.h"
+#include "bench_utils.h"
+
+namespace {
+    // Escribe un archivo IDX con forma {filas, 28, 28} y valores que recorren todo el rango del tipo
+    template <typename T>
+    std::vector<T> write_idx(const std::string& path, IdxType type, std::size_t rows) {
+        const std::vector<std::size_t> shape{rows, 28, 28};
+        std::vector<T> values(rows * 28 * 28);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if constexpr (std::is_floating_point_v<T>) {
+                values[i] = static_cast<T>(i % 1000) * static_cast<T>(-0.37) + static_cast<T>(1e-3);
+            } else {
+                values[i] = static_cast<T>(i * 2654435761u);
+            }
+        }
+
+        std::vector<std::uint8_t> bytes{0, 0, static_cast<std::uint8_t>(type), static_cast<std::uint8_t>(shape.size())};
+        for (std::size_t dim : shape) {
+            for (int shift = 24; shift >= 0; shift -= 8) bytes.push_back(static_cast<std::uint8_t>(dim >> shift));
+        }
+        const std::size_t header = bytes.size();
+        bytes.resize(header + values.size() * sizeof(T));
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            std::uint8_t word[sizeof(T)];
+            std::memcpy(word, &values[i], sizeof(T));
+            for (std::size_t b = 0; b < sizeof(T); ++b) bytes[header + i * sizeof(T) + b] = word[sizeof(T) - 1 - b];
+        }
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                                    static_cast<std::streamsize>(bytes.size()));
+        return values;
+    }
+
+    template <typename T>
+    void run(const char* name, IdxType type, std::size_t rows, ThreadPool& pool) {
+        const std::string path = (std::filesystem::temp_directory_path() / ("idx_bench_" + std::string(name))).string();
+        const std::vector<T> expected = write_idx<T>(path, type, rows);
+        const IdxFile file(path, AccessHint::Sequential);
+        const double megabytes = file.bytes().size() / 1e6;
+        Tensor<T> decoded(file.shape());
+
+        std::cout << std::left << std::setw(7) << name << std::right;
+        for (Kernels::Isa isa : {Kernels::Isa::Generic, Kernels::Isa::AVX2, Kernels::Isa::AVX512VNNI}) {
+            if (Kernels::table_for(isa).isa != isa) continue; // No soportada por esta CPU
+            Kernels::select(isa);
+            const double seconds = time_operation([&] { file.decode_into(decoded.data()); });
+            const bool ok = std::memcmp(decoded.data(), expected.data(), expected.size() * sizeof(T)) == 0;
+            std::cout << "  " << Kernels::isa_name(isa) << " " << std::fixed << std::setprecision(2) << std::setw(6)
+                      << megabytes / seconds / 1e3 << " GB/s" << (ok ? "" : " (INCORRECTO)");
+        }
+        Kernels::select(Kernels::detect_isa());
+        const double seconds = time_operation([&] { file.decode_into(decoded.data(), &pool); });
+        std::cout << "  pool(" << pool.size() << ") " << std::setw(6) << megabytes / seconds / 1e3 << " GB/s";
+
+        // Conversión a float, como se cargarían unos datos de entrenamiento
+        const Tensor<float> as_float = file.decode<float>(&pool);
+        bool ok = true;
+        for (std::size_t i = 0; i < expected.size(); ++i) ok &= as_float.data()[i] == static_cast<float>(expected[i]);
+        std::cout << (ok ? "" : " (float INCORRECTO)") << std::endl;
+        std::filesystem::remove(path);
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t elements = (argc > 1 ? std::stoul(argv[1]) : 16) * 1000000;
+    const std::size_t threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    const std::size_t rows = std::max<std::size_t>(elements / (28 * 28), 1);
+
+    try {
+        ThreadPool pool(threads);
+        std::cout << rows * 28 * 28 << " elementos por archivo" << std::endl;
+        run<std::int8_t>("int8", IdxType::Int8, rows, pool);
+        run<std::int16_t>("int16", IdxType::Int16, rows, pool);
+        run<std::int32_t>("int32", IdxType::Int32, rows, pool);
+        run<float>("float", IdxType::Float32, rows, pool);
+        run<double>("double", IdxType::Float64, rows, pool);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
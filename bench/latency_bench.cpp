@@ -0,0 +1,42 @@
+// Latencia de una inferencia de una sola muestra (predict) con la propagación
+// repartida entre 1..N hilos de un SpinTeam. Muestra los percentiles 50 y 99.
+// Uso: latency_bench [max_hilos] [inferencias]
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <string>
+#include <algorithm>
+#include "../include/common.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv) {
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::min<size_t>(hardware, 4);
+    const size_t requests = argc > 2 ? std::stoul(argv[2]) : 20000;
+
+    NeuralNetwork<double> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.05);
+    Matrix<double> inputs = initialize_matrix<double>(256, INPUT_SIZE);
+    std::vector<double> latencies(requests);
+
+    std::cout << "Núcleos disponibles: " << hardware << ", " << requests << " inferencias" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+        SpinTeam team(threads);
+        nn.set_spin_team(&team);
+        for (size_t i = 0; i < 1000; ++i) nn.predict(inputs[i % inputs.rows()]); // Calentamiento
+
+        int checksum = 0;
+        for (size_t i = 0; i < requests; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            checksum += nn.predict(inputs[i % inputs.rows()]);
+            latencies[i] = seconds_since(start) * 1e6;
+        }
+        nn.set_spin_team(nullptr);
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::setw(3) << threads << " hilos: p50 " << std::fixed << std::setprecision(2)
+                  << std::setw(8) << latencies[requests / 2] << " us  p99 " << std::setw(8)
+                  << latencies[requests * 99 / 100] << " us  (control " << checksum << ")" << std::endl;
+    }
+    return 0;
+}
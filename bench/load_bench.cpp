@@ -0,0 +1,41 @@
+// Tiempo de carga de MNIST: Dataset en float y en bytes (decodificados desde los
+// archivos mapeados) frente a MappedDataset, que solo mapea los archivos. Después
+// entrena una época con cada fuente de bytes para comprobar que dan lo mismo.
+// Uso: load_bench [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv) {
+    const std::string dir = argc > 1 ? argv[1] : "../data";
+    const std::string files[] = {dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                                 dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte"};
+
+    try {
+        const double t_float = time_operation([&] { Dataset<float> d(files[0], files[1], files[2], files[3]); });
+        const double t_bytes = time_operation([&] { Dataset<uint8_t> d(files[0], files[1], files[2], files[3]); });
+        const double t_mapped = time_operation([&] { MappedDataset d(files[0], files[1], files[2], files[3]); });
+        std::cout << std::fixed << std::setprecision(3)
+                  << "Dataset<float>:   " << t_float * 1e3 << " ms" << std::endl
+                  << "Dataset<uint8_t>: " << t_bytes * 1e3 << " ms" << std::endl
+                  << "MappedDataset:    " << t_mapped * 1e3 << " ms" << std::endl;
+
+        const Dataset<uint8_t> copied(files[0], files[1], files[2], files[3]);
+        const MappedDataset mapped(files[0], files[1], files[2], files[3]);
+        const NeuralNetwork<float> initial({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.05f);
+        NeuralNetwork<float> a = initial, b = initial;
+        const float loss_copied = a.train_epoch(copied.get_training_images(), copied.get_training_labels(), 32);
+        const float loss_mapped = b.train_epoch(mapped.get_training_images(), mapped.get_training_labels(), 32);
+        std::cout << std::setprecision(6) << "Pérdida con Dataset<uint8_t>: " << loss_copied
+                  << ", con MappedDataset: " << loss_mapped << " (mapeado: " << std::boolalpha << mapped.is_mapped()
+                  << ")" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
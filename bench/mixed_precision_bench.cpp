@@ -0,0 +1,75 @@
+// float frente a pesos y activaciones en bfloat16 (acumulación en float) sobre
+// MNIST con mini-batch: muestras/s, bytes de pesos y activaciones leídos por paso
+// y precisión final, con redondeo al par y estocástico de la copia compacta.
+// Uso: mixed_precision_bench [épocas] [tamaño_de_lote] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+constexpr int HIDDEN = 128;
+
+template <typename Storage>
+void run(const char* name, const Dataset<float>& mnist, int epochs, size_t batch_size, bool stochastic) {
+    const auto& train_images = mnist.get_training_images();
+    const auto& test_images = mnist.get_test_images();
+
+    NeuralNetwork<float, Storage> nn({INPUT_SIZE, HIDDEN, OUTPUT_SIZE}, 0.05f);
+    nn.set_stochastic_rounding(stochastic);
+    const auto start = std::chrono::steady_clock::now();
+    float loss = 0;
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        loss = nn.train_epoch(train_images, mnist.get_training_labels(), batch_size);
+    }
+    const double train_rate = epochs * train_images.rows() / seconds_since(start);
+    const double accuracy = nn.evaluate(test_images, mnist.get_test_labels());
+
+    // Cada paso lee los pesos dos veces (propagación y delta) y las activaciones ocultas dos veces
+    const size_t weight_bytes = 2 * (INPUT_SIZE * HIDDEN + HIDDEN * OUTPUT_SIZE) * sizeof(Storage);
+    const size_t activation_bytes = 2 * batch_size * HIDDEN * sizeof(Storage);
+
+    std::cout << name << ": " << std::fixed << std::setprecision(0) << std::setw(7) << train_rate
+              << " muestras/s, " << std::setw(4) << (weight_bytes + activation_bytes) / 1024
+              << " KiB/paso, pérdida " << std::setprecision(4) << loss << ", precisión "
+              << std::setprecision(2) << accuracy << "%" << std::endl;
+}
+
+// Error medio de redondear a bfloat16 y sesgo acumulado al sumar un paso pequeño muchas veces
+void rounding_check() {
+    constexpr size_t n = 1 << 16;
+    Matrix<float> v = initialize_matrix<float>(1, n);
+    Vector<bfloat16> nearest(n), stochastic(n);
+    to_bfloat16(v.data(), nearest.data(), n);
+    to_bfloat16(v.data(), stochastic.data(), n, true, 12345);
+    double err_nearest = 0, err_stochastic = 0, bias = 0;
+    for (size_t i = 0; i < n; ++i) {
+        err_nearest += std::abs(static_cast<float>(nearest[i]) - v(0, i));
+        err_stochastic += std::abs(static_cast<float>(stochastic[i]) - v(0, i));
+        bias += static_cast<float>(stochastic[i]) - v(0, i);
+    }
+    std::cout << "redondeo a bfloat16: error medio al par " << std::scientific << std::setprecision(2)
+              << err_nearest / n << ", estocástico " << err_stochastic / n << " (sesgo medio "
+              << bias / n << ")" << std::defaultfloat << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const int epochs = argc > 1 ? std::stoi(argv[1]) : 3;
+    const size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 32;
+    const std::string dir = argc > 3 ? argv[3] : "../data";
+
+    try {
+        Dataset<float> mnist(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                             dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        run<float>("float               ", mnist, epochs, batch_size, false);
+        run<bfloat16>("bfloat16 (al par)   ", mnist, epochs, batch_size, false);
+        run<bfloat16>("bfloat16 estocástico", mnist, epochs, batch_size, true);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    rounding_check();
+    return 0;
+}
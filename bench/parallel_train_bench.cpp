@@ -0,0 +1,63 @@
+// Escalado del entrenamiento con paralelismo de datos: mide muestras/s de una
+// época para 1..N hilos y la eficiencia respecto al entrenamiento con un hilo.
+// Antes comprueba que train_epoch rechaza entradas de ancho distinto al de la red.
+// Uso: parallel_train_bench [max_hilos] [tamaño_de_lote]
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <string>
+#include "../include/common.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv) {
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t max_threads = argc > 1 ? std::stoul(argv[1]) : hardware;
+    const size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 256;
+    const size_t samples = 16384;
+
+    Matrix<float> inputs = initialize_matrix<float>(samples, INPUT_SIZE);
+    std::vector<int> labels(samples);
+    for (size_t i = 0; i < samples; ++i) labels[i] = static_cast<int>(i % OUTPUT_SIZE);
+
+    // Comprobación: un ancho de entrada distinto del de la primera capa se rechaza antes de entrenar
+    {
+        NeuralNetwork<float> nn({INPUT_SIZE, 32, OUTPUT_SIZE}, 0.01f);
+        Matrix<float> narrow = initialize_matrix<float>(64, 100);
+        std::vector<int> narrow_labels(64, 0);
+        for (size_t batch : {size_t{1}, batch_size}) {
+            try {
+                nn.train_epoch(narrow, narrow_labels, batch, max_threads);
+                std::cerr << "Error: train_epoch aceptó entradas de 100 columnas (lote " << batch << ")" << std::endl;
+                return 1;
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    }
+
+    std::cout << "Núcleos disponibles: " << hardware << ", lote " << batch_size
+              << ", " << samples << " muestras por época" << std::endl;
+
+    // Potencias de dos hasta max_threads, más el propio max_threads
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    double base_rate = 0.0;
+    for (size_t threads : thread_counts) {
+        NeuralNetwork<float> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.01f);
+        nn.train_epoch(inputs, labels, batch_size, threads); // Calentamiento y reserva de workspaces
+
+        const auto start = std::chrono::steady_clock::now();
+        const float loss = nn.train_epoch(inputs, labels, batch_size, threads);
+        const double rate = samples / seconds_since(start);
+        if (threads == 1) base_rate = rate;
+
+        const double speedup = rate / base_rate;
+        std::cout << std::setw(3) << threads << " hilos: " << std::fixed << std::setprecision(0)
+                  << std::setw(9) << rate << " muestras/s  speedup " << std::setprecision(2) << speedup
+                  << "  eficiencia " << std::setprecision(0) << 100.0 * speedup / threads << "%"
+                  << "  pérdida " << std::setprecision(4) << loss << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+// double frente a float de extremo a extremo sobre MNIST: muestras/s de
+// entrenamiento e inferencia y precisión final con los mismos hiperparámetros.
+// También compara el error del producto punto largo en float con y sin suma por pares.
+// Uso: precision_bench [épocas] [tamaño_de_lote] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+template <typename T>
+void run(const char* name, const std::string& dir, int epochs, size_t batch_size) {
+    Dataset<T> mnist(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                     dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+    const auto& train_images = mnist.get_training_images();
+    const auto& test_images = mnist.get_test_images();
+
+    NeuralNetwork<T> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, static_cast<T>(0.05));
+    const auto start = std::chrono::steady_clock::now();
+    T loss = 0;
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        loss = nn.train_epoch(train_images, mnist.get_training_labels(), batch_size);
+    }
+    const double train_rate = epochs * train_images.rows() / seconds_since(start);
+
+    std::vector<int> predicted(test_images.rows());
+    const double t_infer = time_operation([&] {
+        nn.predict_batch(test_images.data(), test_images.rows(), predicted.data());
+    });
+    const double accuracy = nn.evaluate(test_images, mnist.get_test_labels());
+
+    std::cout << name << ": entrenamiento " << std::fixed << std::setprecision(0) << std::setw(8)
+              << train_rate << " muestras/s, inferencia " << std::setw(9) << test_images.rows() / t_infer
+              << " img/s, pérdida " << std::setprecision(4) << loss << ", precisión "
+              << std::setprecision(2) << accuracy << "%" << std::endl;
+}
+
+// Error relativo del producto punto de n elementos en float frente a la referencia en double
+void dot_accuracy(size_t n) {
+    Matrix<float> v = initialize_matrix<float>(2, n);
+    double reference = 0.0;
+    for (size_t i = 0; i < n; ++i) reference += static_cast<double>(v(0, i)) * v(1, i);
+    const float blocked = dot_product(v[0].data(), v[1].data(), n);
+    const float direct = Kernels::dot(v[0].data(), v[1].data(), n);
+    std::cout << "dot float n=" << n << ": error relativo por pares " << std::scientific << std::setprecision(2)
+              << std::abs(blocked - reference) / std::abs(reference) << ", de una pasada "
+              << std::abs(direct - reference) / std::abs(reference) << std::defaultfloat << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const int epochs = argc > 1 ? std::stoi(argv[1]) : 3;
+    const size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 32;
+    const std::string dir = argc > 3 ? argv[3] : "../data";
+
+    try {
+        run<double>("double", dir, epochs, batch_size);
+        run<float>("float ", dir, epochs, batch_size);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    dot_accuracy(1 << 16);
+    dot_accuracy(1 << 22);
+    return 0;
+}
@@ -0,0 +1,34 @@
+// Rendimiento de la clasificación masiva: predict por muestra (producto
+// matriz-vector por capa) frente a predict_batch (bloques por GEMM, argmax
+// directo sobre los logits). Uso: predict_batch_bench [muestras]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "../include/common.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+template <typename T>
+void run(const char* name, size_t samples) {
+    NeuralNetwork<T> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, static_cast<T>(0.05));
+    Matrix<T> inputs = initialize_matrix<T>(samples, INPUT_SIZE);
+    std::vector<int> single(samples), batched(samples);
+
+    InferenceScratch<T> scratch = nn.make_inference_scratch();
+    const double t_single = time_operation([&] {
+        for (size_t i = 0; i < samples; ++i) single[i] = nn.predict(inputs[i], scratch);
+    });
+    const double t_batch = time_operation([&] { nn.predict_batch(inputs.data(), samples, batched.data()); });
+
+    std::cout << name << ": por muestra " << std::fixed << std::setprecision(0) << std::setw(9)
+              << samples / t_single << " img/s, por bloques " << std::setw(9) << samples / t_batch
+              << " img/s  x" << std::setprecision(2) << t_single / t_batch
+              << (single == batched ? "" : "  (¡las predicciones difieren!)") << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const size_t samples = argc > 1 ? std::stoul(argv[1]) : 10000;
+    run<double>("double", samples);
+    run<float>("float ", samples);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Entrenamiento con cuantización simulada (QAT) frente a cuantización posterior
+// (PTQ) en una red estrecha sobre MNIST. Ambas parten de la misma red float y
+// entrenan las mismas épocas adicionales: una en float (y luego se calibra) y
+// otra en QAT. Se compara la precisión del motor int8 y el coste de cada época.
+// Uso: qat_bench [épocas_float] [épocas_ajuste] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "../include/quantized.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv) {
+    const int epochs = argc > 1 ? std::stoi(argv[1]) : 3;
+    const int tuning = argc > 2 ? std::stoi(argv[2]) : 2;
+    const std::string dir = argc > 3 ? argv[3] : "../data";
+    constexpr size_t batch_size = 32;
+
+    try {
+        Dataset<float> mnist(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                             dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        Dataset<uint8_t> raw(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                             dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        const auto& train_images = mnist.get_training_images();
+        const auto& train_labels = mnist.get_training_labels();
+        const auto& test_labels = mnist.get_test_labels();
+
+        NeuralNetwork<float> base({INPUT_SIZE, 8, 8, OUTPUT_SIZE}, 0.05f);
+        for (int epoch = 0; epoch < epochs; ++epoch) base.train_epoch(train_images, train_labels, batch_size);
+
+        // Las mismas épocas de ajuste en float y en QAT, cronometradas
+        NeuralNetwork<float> ptq = base;
+        NeuralNetwork<float> qat = base;
+        qat.enable_quantization_aware(train_images);
+        double t_float = 0, t_qat = 0;
+        for (int epoch = 0; epoch < tuning; ++epoch) {
+            auto start = std::chrono::steady_clock::now();
+            ptq.train_epoch(train_images, train_labels, batch_size);
+            t_float += seconds_since(start);
+            start = std::chrono::steady_clock::now();
+            qat.train_epoch(train_images, train_labels, batch_size);
+            t_qat += seconds_since(start);
+        }
+
+        const double float_accuracy = ptq.evaluate(mnist.get_test_images(), test_labels);
+        const double ptq_accuracy = QuantizedNetwork(ptq, train_images).evaluate(raw.get_test_images(), test_labels);
+        const double simulated_accuracy = qat.evaluate(mnist.get_test_images(), test_labels);
+        const double qat_accuracy = QuantizedNetwork(qat).evaluate(raw.get_test_images(), test_labels);
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Época float: " << t_float / tuning << " s, época QAT: " << t_qat / tuning << " s ("
+                  << t_qat / t_float << "x)" << std::endl
+                  << "Precisión float: " << float_accuracy << "%" << std::endl
+                  << "Precisión int8 PTQ: " << ptq_accuracy << "% (" << std::showpos << ptq_accuracy - float_accuracy
+                  << std::noshowpos << ")" << std::endl
+                  << "Precisión int8 QAT: " << qat_accuracy << "% (" << std::showpos << qat_accuracy - float_accuracy
+                  << std::noshowpos << "), simulada al entrenar: " << simulated_accuracy << "%" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Inferencia int8 (cuantización posterior al entrenamiento) frente a float sobre
+// MNIST: imágenes/s por lotes y por muestra, y precisión de ambas redes. La red
+// int8 se mide con cada variante de kernels disponible.
+// Uso: quantized_bench [épocas] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "../include/quantized.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv) {
+    const int epochs = argc > 1 ? std::stoi(argv[1]) : 3;
+    const std::string dir = argc > 2 ? argv[2] : "../data";
+
+    try {
+        Dataset<float> mnist(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                             dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        Dataset<uint8_t> raw(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                             dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        const auto& test_images = mnist.get_test_images();
+        const auto& test_bytes = raw.get_test_images();
+        const auto& test_labels = mnist.get_test_labels();
+        const size_t n = test_images.rows();
+
+        NeuralNetwork<float> nn({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.05f);
+        for (int epoch = 0; epoch < epochs; ++epoch) {
+            nn.train_epoch(mnist.get_training_images(), mnist.get_training_labels(), 32);
+        }
+        const QuantizedNetwork qnn(nn, mnist.get_training_images());
+
+        std::vector<int> predicted(n);
+        const double t_float = time_operation([&] { nn.predict_batch(test_images.data(), n, predicted.data()); });
+        InferenceScratch<float> scratch = nn.make_inference_scratch();
+        const double t_float_one = time_operation([&] {
+            for (size_t i = 0; i < n; ++i) predicted[i] = nn.predict(test_images[i], scratch);
+        });
+        const double float_accuracy = nn.evaluate(test_images, test_labels);
+        std::cout << "float                : " << std::fixed << std::setprecision(0) << std::setw(9) << n / t_float
+                  << " img/s por lotes, " << std::setw(8) << n / t_float_one << " img/s por muestra, precisión "
+                  << std::setprecision(2) << float_accuracy << "%" << std::endl;
+
+        for (Kernels::Isa isa : {Kernels::Isa::Generic, Kernels::Isa::AVX2, Kernels::Isa::AVX512,
+                                 Kernels::Isa::AVX512VNNI}) {
+            if (Kernels::table_for(isa).isa != isa) continue; // No soportada por esta CPU
+            Kernels::select(isa);
+            const double t_int8 = time_operation([&] { qnn.predict_batch(test_bytes.data(), n, predicted.data()); });
+            QuantizedScratch qscratch = qnn.make_scratch(1);
+            const double t_int8_one = time_operation([&] {
+                for (size_t i = 0; i < n; ++i) predicted[i] = qnn.predict(test_bytes[i], qscratch);
+            });
+            const double accuracy = qnn.evaluate(test_bytes, test_labels);
+            std::cout << "int8 " << std::left << std::setw(16) << Kernels::isa_name(isa) << std::right << ": "
+                      << std::setprecision(0) << std::setw(9) << n / t_int8 << " img/s por lotes ("
+                      << std::setprecision(1) << t_float / t_int8 << "x), " << std::setprecision(0) << std::setw(8)
+                      << n / t_int8_one << " img/s por muestra (" << std::setprecision(1) << t_float_one / t_int8_one
+                      << "x), precisión " << std::setprecision(2) << accuracy << "% ("
+                      << std::showpos << accuracy - float_accuracy << std::noshowpos << ")" << std::endl;
+        }
+        Kernels::select(Kernels::detect_isa());
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Dataset en T frente a Dataset<uint8_t> normalizado lote a lote: memoria de las
+// imágenes, muestras/s de entrenamiento e inferencia y precisión. Las dos redes
+// parten de los mismos pesos y la conversión es la misma, así que deben acabar
+// con idénticos resultados.
+// Uso: storage_bench [épocas] [tamaño_de_lote] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+template <typename T, typename Pixel>
+void run(const char* name, const std::string& dir, const NeuralNetwork<T>& initial, int epochs, size_t batch_size) {
+    Dataset<Pixel> mnist(dir + "/train-images.idx3-ubyte", dir + "/train-labels.idx1-ubyte",
+                         dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+    const auto& train_images = mnist.get_training_images();
+    const auto& test_images = mnist.get_test_images();
+    const double megabytes = (train_images.size() + test_images.size()) * sizeof(Pixel) / 1e6;
+
+    NeuralNetwork<T> nn = initial;
+    const auto start = std::chrono::steady_clock::now();
+    T loss = 0;
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        loss = nn.train_epoch(train_images, mnist.get_training_labels(), batch_size);
+    }
+    const double train_rate = epochs * train_images.rows() / seconds_since(start);
+
+    std::vector<int> predicted(test_images.rows());
+    const double t_infer = time_operation([&] {
+        nn.predict_batch(test_images.data(), test_images.rows(), predicted.data());
+    });
+    const double accuracy = nn.evaluate(test_images, mnist.get_test_labels());
+
+    std::cout << name << ": " << std::fixed << std::setprecision(1) << std::setw(6) << megabytes
+              << " MB, entrenamiento " << std::setprecision(0) << std::setw(8) << train_rate
+              << " muestras/s, inferencia " << std::setw(9) << test_images.rows() / t_infer
+              << " img/s, pérdida " << std::setprecision(6) << loss << ", precisión "
+              << std::setprecision(2) << accuracy << "%" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const int epochs = argc > 1 ? std::stoi(argv[1]) : 1;
+    const size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 32;
+    const std::string dir = argc > 3 ? argv[3] : "../data";
+
+    try {
+        const NeuralNetwork<double> net_double({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.05);
+        run<double, double>("double en double", dir, net_double, epochs, batch_size);
+        run<double, uint8_t>("double en bytes ", dir, net_double, epochs, batch_size);
+        const NeuralNetwork<float> net_float({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.05f);
+        run<float, float>("float en float  ", dir, net_float, epochs, batch_size);
+        run<float, uint8_t>("float en bytes  ", dir, net_float, epochs, batch_size);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
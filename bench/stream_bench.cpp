@@ -0,0 +1,88 @@
+// Entrenamiento desde disco por bloques (StreamingDataset) con io_uring y con hilos
+// de pread, frente al conjunto mapeado entero (MappedDataset): memoria reservada,
+// muestras/s de entrenamiento y precisión. Antes comprueba que una época entrega
+// cada muestra exactamente una vez, con su etiqueta.
+// Uso: stream_bench [presupuesto_MiB] [bloque_KiB] [tamaño_de_lote] [directorio_de_datos]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "../include/common.h"
+#include "../include/dataset.h"
+#include "../include/streaming_dataset.h"
+#include "../include/network.h"
+#include "bench_utils.h"
+
+namespace {
+    // Huella de una muestra (FNV-1a de los píxeles y la etiqueta); su suma no depende del orden
+    std::uint64_t sample_hash(std::span<const uint8_t> pixels, int label) {
+        std::uint64_t h = 1469598103934665603ull ^ static_cast<std::uint64_t>(label);
+        for (uint8_t byte : pixels) h = (h ^ byte) * 1099511628211ull;
+        return h;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t budget = (argc > 1 ? std::stoul(argv[1]) : 8) << 20;
+    const size_t chunk = (argc > 2 ? std::stoul(argv[2]) : 1024) << 10;
+    const size_t batch_size = argc > 3 ? std::stoul(argv[3]) : 32;
+    const std::string dir = argc > 4 ? argv[4] : "../data";
+    const std::string images = dir + "/train-images.idx3-ubyte", labels = dir + "/train-labels.idx1-ubyte";
+
+    try {
+        const MappedDataset mnist(images, labels, dir + "/t10k-images.idx3-ubyte", dir + "/t10k-labels.idx1-ubyte");
+        const MatrixView<uint8_t> train_images = mnist.get_training_images();
+        std::uint64_t expected = 0;
+        for (size_t i = 0; i < train_images.rows(); ++i) {
+            expected += sample_hash(train_images[i], mnist.get_training_labels()[i]);
+        }
+
+        const NeuralNetwork<float> initial({INPUT_SIZE, 128, OUTPUT_SIZE}, 0.05f);
+        {
+            NeuralNetwork<float> nn = initial;
+            const auto start = std::chrono::steady_clock::now();
+            const float loss = nn.train_epoch(train_images, mnist.get_training_labels(), batch_size);
+            const double rate = train_images.rows() / seconds_since(start);
+            std::cout << "MappedDataset:          " << std::fixed << std::setprecision(1) << std::setw(6)
+                      << train_images.size() / 1048576.0 << " MiB mapeados, " << std::setprecision(0)
+                      << std::setw(7) << rate << " muestras/s, pérdida " << std::setprecision(6) << loss
+                      << ", precisión " << std::setprecision(2)
+                      << nn.evaluate(mnist.get_test_images(), mnist.get_test_labels()) << "%" << std::endl;
+        }
+
+        for (ReadBackend backend : {ReadBackend::IoUring, ReadBackend::Threads}) {
+            std::unique_ptr<StreamingDataset> stream;
+            try {
+                stream = std::make_unique<StreamingDataset>(images, labels, budget, chunk, backend);
+            } catch (const std::runtime_error& e) {
+                std::cout << e.what() << std::endl;
+                continue;
+            }
+            stream->set_seed(42);
+
+            std::uint64_t received = 0;
+            size_t count = 0;
+            stream->for_each_chunk(batch_size, [&](MatrixView<uint8_t> rows, const std::vector<int>& tags) {
+                for (size_t i = 0; i < rows.rows(); ++i) received += sample_hash(rows[i], tags[i]);
+                count += rows.rows();
+            });
+
+            NeuralNetwork<float> nn = initial;
+            const auto start = std::chrono::steady_clock::now();
+            const float loss = nn.train_epoch(*stream, batch_size);
+            const double rate = stream->size() / seconds_since(start);
+            std::cout << (backend == ReadBackend::IoUring ? "StreamingDataset uring: " : "StreamingDataset pread: ")
+                      << std::setprecision(1) << std::setw(6) << stream->memory_bytes() / 1048576.0
+                      << " MiB en buffers (" << stream->chunks() << " bloques de " << stream->chunk_rows()
+                      << ", " << stream->read_ahead() << " por adelantado), " << std::setprecision(0)
+                      << std::setw(7) << rate << " muestras/s, pérdida " << std::setprecision(6) << loss
+                      << ", precisión " << std::setprecision(2)
+                      << nn.evaluate(mnist.get_test_images(), mnist.get_test_labels()) << "%, muestras "
+                      << (count == train_images.rows() && received == expected ? "completas" : "INCORRECTAS")
+                      << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
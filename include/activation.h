@@ -4,6 +4,7 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 namespace Activation {
 
@@ -54,6 +55,53 @@ namespace Activation {
 
         return exp_values;
     }
+
+    /**
+     * Softmax y entropía cruzada fusionadas sobre un lote de logits.
+     * Usa log-sum-exp (loss = log(sum(exp(z))) - z[label]) y escribe en la misma
+     * pasada el gradiente respecto a los logits: (softmax(z) - one_hot(label)) * grad_scale.
+     * Las etiquetas se leen como enteros; no hace falta materializar vectores one-hot.
+     * @tparam T Tipo de dato.
+     * @param logits Lote de logits (batch filas de classes elementos).
+     * @param batch Número de muestras del lote.
+     * @param classes Número de clases.
+     * @param labels Etiqueta de cada muestra.
+     * @param grad Gradiente de salida (misma forma que logits; puede coincidir con logits).
+     * @param grad_scale Escala del gradiente (por ejemplo, 1 / batch para promediar).
+     * @return Suma de la pérdida de todas las muestras del lote.
+     */
+    template <typename T>
+    T softmax_cross_entropy(const T* logits, size_t batch, size_t classes, const int* labels,
+                            T* grad, T grad_scale) {
+        T total_loss = 0;
+        for (size_t n = 0; n < batch; ++n) {
+            const T* z = logits + n * classes;
+            T* g = grad + n * classes;
+            const int label = labels[n];
+            if (label < 0 || static_cast<size_t>(label) >= classes) {
+                throw std::out_of_range("Etiqueta fuera del rango de clases.");
+            }
+
+            T max_elem = z[0];
+            for (size_t j = 1; j < classes; ++j) {
+                max_elem = std::max(max_elem, z[j]);
+            }
+            const T label_logit = z[label]; // Se lee antes de sobrescribir si grad == logits
+            T sum_exp = 0;
+            for (size_t j = 0; j < classes; ++j) {
+                g[j] = std::exp(z[j] - max_elem); // Exponencial estabilizada
+                sum_exp += g[j];
+            }
+
+            total_loss += max_elem + std::log(sum_exp) - label_logit;
+            const T norm = grad_scale / sum_exp;
+            for (size_t j = 0; j < classes; ++j) {
+                g[j] *= norm;
+            }
+            g[label] -= grad_scale;
+        }
+        return total_loss;
+    }
 }
 
 #endif // ACTIVATION_H
@@ -0,0 +1,62 @@
+#ifndef BFLOAT16_H
+#define BFLOAT16_H
+
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+#include "kernels.h"
+
+/**
+ * Número en formato bfloat16: los 16 bits altos de un float (signo, los 8 bits
+ * de exponente y 7 de mantisa). Tiene el mismo rango que float con unas dos
+ * cifras decimales de precisión, así que sirve para guardar pesos y activaciones
+ * a la mitad de bytes mientras las operaciones se hacen en float.
+ * Solo almacena: para operar se convierte explícitamente a float.
+ */
+struct bfloat16 {
+    std::uint16_t bits = 0;
+
+    bfloat16() = default;
+
+    // Conversión con redondeo al par más cercano
+    explicit bfloat16(float value) : bits(round_nearest(value)) {}
+
+    explicit operator float() const {
+        return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+    }
+
+    static std::uint16_t round_nearest(float value) {
+        const std::uint32_t raw = std::bit_cast<std::uint32_t>(value);
+        if ((raw & 0x7FFFFFFFu) > 0x7F800000u) return static_cast<std::uint16_t>((raw >> 16) | 0x40u); // NaN
+        return static_cast<std::uint16_t>((raw + 0x7FFFu + ((raw >> 16) & 1u)) >> 16);
+    }
+};
+
+static_assert(sizeof(bfloat16) == sizeof(std::uint16_t), "bfloat16 debe ocupar 16 bits.");
+
+/**
+ * Convierte un bloque de floats a bfloat16 con los kernels vectoriales.
+ * @param src Valores de entrada.
+ * @param dst Destino (n elementos).
+ * @param n Número de elementos.
+ * @param stochastic Si es true, redondeo estocástico con la semilla seed; si no, al par más cercano.
+ * @param seed Semilla del ruido del redondeo estocástico.
+ */
+inline void to_bfloat16(const float* src, bfloat16* dst, std::size_t n, bool stochastic = false,
+                        std::uint32_t seed = 0) {
+    std::uint16_t* out = reinterpret_cast<std::uint16_t*>(dst);
+    if (stochastic) {
+        Kernels::round_to_bf16_stochastic(src, out, n, seed);
+    } else {
+        Kernels::round_to_bf16(src, out, n);
+    }
+}
+
+/**
+ * Convierte un bloque de bfloat16 a float (sin pérdida).
+ */
+inline void to_float(const bfloat16* src, float* dst, std::size_t n) {
+    Kernels::widen_bf16(reinterpret_cast<const std::uint16_t*>(src), dst, n);
+}
+
+#endif // BFLOAT16_H
@@ -0,0 +1,77 @@
+#ifndef CHUNK_READER_H
+#define CHUNK_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+/**
+ * Mecanismo con el que ChunkReader hace las lecturas asíncronas.
+ * IoUring: anillos de io_uring (Linux 5.6 o posterior) con llamadas al sistema
+ * directas, sin liburing; el kernel lee mientras el programa calcula.
+ * Threads: hilos de E/S propios que bloquean en pread. No se usa el ThreadPool de
+ * cálculo porque un hilo bloqueado en el disco dejaría de entrenar.
+ * Auto: IoUring si el kernel lo admite; si no, Threads. La variable de entorno
+ * REDNEURONAL_IO=threads fuerza los hilos.
+ */
+enum class ReadBackend { Auto, IoUring, Threads };
+
+/**
+ * Lector asíncrono de rangos de bytes de un archivo de solo lectura. Cada lectura
+ * se identifica con una etiqueta elegida por el llamador; submit encola la lectura
+ * y vuelve enseguida, y wait espera a que termine una etiqueta concreta (las
+ * lecturas cortas se reenvían hasta completar el rango).
+ * Los buffers de destino deben seguir vivos hasta que termine su lectura.
+ * No es seguro usar un mismo lector desde varios hilos.
+ */
+class ChunkReader {
+public:
+    /**
+     * Abre el archivo y prepara el mecanismo de lectura.
+     * @param path Ruta del archivo.
+     * @param depth Lecturas en vuelo como máximo (mínimo 1).
+     * @param backend Mecanismo de lectura; IoUring lanza si el kernel no lo admite.
+     * @throws std::runtime_error si no se puede abrir el archivo o iniciar el mecanismo.
+     */
+    explicit ChunkReader(const std::string& path, std::size_t depth = 4, ReadBackend backend = ReadBackend::Auto);
+    ~ChunkReader();
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    // Tamaño del archivo en bytes
+    std::size_t size() const;
+
+    // Lecturas en vuelo como máximo
+    std::size_t depth() const;
+
+    // true si las lecturas van por io_uring
+    bool uses_io_uring() const;
+
+    /**
+     * Encola la lectura de dst.size() bytes desde offset.
+     * @param offset Posición en el archivo.
+     * @param dst Destino (debe seguir vivo hasta que wait devuelva para esta etiqueta).
+     * @param tag Etiqueta de la lectura (no debe estar ya en vuelo; UINT64_MAX está reservada para read).
+     * @throws std::out_of_range si el rango se sale del archivo.
+     * @throws std::runtime_error si ya hay depth() lecturas en vuelo.
+     */
+    void submit(std::size_t offset, std::span<std::uint8_t> dst, std::uint64_t tag);
+
+    /**
+     * Espera a que termine la lectura con la etiqueta dada.
+     * @throws std::runtime_error si la lectura falló o la etiqueta no está en vuelo.
+     */
+    void wait(std::uint64_t tag);
+
+    // Lectura síncrona (para cabeceras); no cuenta para depth()
+    void read(std::size_t offset, std::span<std::uint8_t> dst);
+
+private:
+    struct State; // Descriptor, anillos de io_uring o hilos de E/S, según la plataforma
+    std::unique_ptr<State> state;
+};
+
+#endif // CHUNK_READER_H
@@ -9,15 +9,21 @@
 #include <algorithm> // Para std::max_element
 #include <cstdint>   // Para uint32_t
 #include <type_traits> // Para verificar tipos en plantillas
+#include <span>
+#include "tensor.h"    // Tensor contiguo usado como Matrix
+#include "kernels.h"   // Kernels vectoriales con selección por CPUID
+#include "thread_pool.h" // Pool de hilos opcional para los recorridos largos
 
 // Constantes globales
 constexpr double EPSILON = 1e-6; // Pequeño valor para evitar divisiones por cero
 constexpr int INPUT_SIZE = 784;  // Número de píxeles en las imágenes MNIST
 constexpr int OUTPUT_SIZE = 10;  // Número de categorías (dígitos 0-9)
+constexpr double PIXEL_SCALE = 1.0 / 255.0; // Normalización de un píxel en bytes a [0, 1]
 
-// Tipos de datos genéricos para manejar matrices y vectores
+// Tipos de datos genéricos para manejar matrices y vectores.
+// Matrix es un tensor row-major de dos dimensiones con un solo buffer contiguo.
 template <typename T>
-using Matrix = std::vector<std::vector<T>>;
+using Matrix = Tensor<T>;
 template <typename T>
 using Vector = std::vector<T>;
 
@@ -59,13 +65,14 @@ inline file_header_t convert_big_endian(const file_header_t& src) {
 
 /**
  * Genera un número aleatorio en un rango específico.
- * @tparam T Tipo de dato.
+ * @tparam T Tipo de dato (float o double).
  * @param min Valor mínimo.
  * @param max Valor máximo.
  * @return Número aleatorio en el rango [min, max].
  */
 template <typename T>
 T random_value(T min, T max) {
+    static_assert(std::is_floating_point_v<T>, "Solo se admiten tipos de punto flotante");
     static std::random_device rd;
     static std::mt19937 gen(rd());
     std::uniform_real_distribution<T> dis(min, max);
@@ -80,16 +87,39 @@ T random_value(T min, T max) {
  * @return Matriz inicializada con valores aleatorios.
  */
 template <typename T>
-Matrix<T> initialize_matrix(int rows, int cols) {
-    Matrix<T> mat(rows, Vector<T>(cols));
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            mat[i][j] = random_value<T>(-0.5, 0.5); // Inicializa con valores pequeños
-        }
+Matrix<T> initialize_matrix(size_t rows, size_t cols) {
+    Matrix<T> mat(rows, cols);
+    for (T& value : mat) {
+        value = random_value<T>(static_cast<T>(-0.5), static_cast<T>(0.5)); // Inicializa con valores pequeños
     }
     return mat;
 }
 
+// Elementos que el kernel de producto punto reduce de una vez; por encima se suma por pares
+constexpr size_t DOT_BLOCK = 1024;
+
+/**
+ * Calcula el producto punto entre dos bloques contiguos, sin validar tamaños.
+ * Es la variante usada en los bucles internos (por ejemplo, filas de una Matrix);
+ * para float y double usa el kernel SIMD elegido al arrancar, que ya reparte la
+ * suma entre varios acumuladores vectoriales. Los bloques de más de DOT_BLOCK
+ * elementos se parten por la mitad y se suman por pares, de modo que el error de
+ * redondeo crece con log(n) y no con n (importante en float).
+ * @tparam T Tipo de dato.
+ * @param a Puntero al primer bloque.
+ * @param b Puntero al segundo bloque.
+ * @param n Número de elementos.
+ * @return Producto punto de los bloques.
+ */
+template <typename T>
+T dot_product(const T* a, const T* b, size_t n) {
+    if (n <= DOT_BLOCK) {
+        return Kernels::dot(a, b, n);
+    }
+    const size_t half = (n / 2 + DOT_BLOCK - 1) / DOT_BLOCK * DOT_BLOCK; // Mitad alineada a bloques
+    return dot_product(a, b, half) + dot_product(a + half, b + half, n - half);
+}
+
 /**
  * Calcula el producto punto entre dos vectores.
  * @tparam T Tipo de dato.
@@ -102,44 +132,315 @@ T dot_product(const Vector<T>& a, const Vector<T>& b) {
     if (a.size() != b.size()) {
         throw std::invalid_argument("Los vectores deben tener el mismo tamaño.");
     }
-    T result = 0;
-    for (size_t i = 0; i < a.size(); ++i) {
-        result += a[i] * b[i];
+    return dot_product(a.data(), b.data(), a.size());
+}
+
+/**
+ * Parámetros de bloqueo del GEMM para cada tipo de dato.
+ * MR x NR es el bloque de C que vive en registros; KC, MC y NC dimensionan los
+ * paneles empaquetados para que quepan en L1 (panel de B), L2 (panel de A) y L3.
+ * @tparam T Tipo de dato.
+ */
+template <typename T>
+struct GemmBlocking {
+    static constexpr size_t MR = Kernels::GEMM_MR;
+    static constexpr size_t NR = Kernels::gemm_nr<T>; // Una línea de caché: 8 doubles o 16 floats
+    static constexpr size_t KC = 256;
+    static constexpr size_t MC = 128;
+    static constexpr size_t NC = 2048;
+};
+
+/**
+ * Empaqueta un bloque mc x kc de op(A) en paneles de MR filas.
+ * Cada panel guarda, para cada p, las MR filas consecutivas; las filas que
+ * sobran en el último panel se rellenan con ceros. Si A se guarda en otro tipo
+ * (por ejemplo bfloat16), cada valor se convierte a T al copiarlo.
+ */
+template <typename T, typename S>
+void gemm_pack_a(bool trans_a, const S* a, size_t lda, size_t row0, size_t col0,
+                 size_t mc, size_t kc, T* packed) {
+    constexpr size_t MR = GemmBlocking<T>::MR;
+    for (size_t ir = 0; ir < mc; ir += MR) {
+        const size_t rows = std::min(MR, mc - ir);
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t r = 0; r < MR; ++r) {
+                const size_t i = row0 + ir + r, k = col0 + p;
+                *packed++ = (r < rows) ? static_cast<T>(trans_a ? a[k * lda + i] : a[i * lda + k])
+                                       : static_cast<T>(0);
+            }
+        }
     }
-    return result;
+}
+
+/**
+ * Empaqueta un bloque kc x nc de op(B) en paneles de NR columnas.
+ * Cada panel guarda, para cada p, las NR columnas consecutivas (relleno con ceros),
+ * convertidas a T.
+ */
+template <typename T, typename S>
+void gemm_pack_b(bool trans_b, const S* b, size_t ldb, size_t row0, size_t col0,
+                 size_t kc, size_t nc, T* packed) {
+    constexpr size_t NR = GemmBlocking<T>::NR;
+    for (size_t jr = 0; jr < nc; jr += NR) {
+        const size_t cols = std::min(NR, nc - jr);
+        for (size_t p = 0; p < kc; ++p) {
+            const size_t k = row0 + p;
+            for (size_t c = 0; c < NR; ++c) {
+                const size_t j = col0 + jr + c;
+                *packed++ = (c < cols) ? static_cast<T>(trans_b ? b[j * ldb + k] : b[k * ldb + j])
+                                       : static_cast<T>(0);
+            }
+        }
+    }
+}
+
+/**
+ * Micro-kernel del GEMM: acumula en registros el producto de un panel de A
+ * (MR filas) por un panel de B (NR columnas) a lo largo de kc. Usa la variante
+ * SIMD elegida por CPUID (Kernels::gemm_micro).
+ * @param kc Longitud de la dimensión compartida.
+ * @param a Panel empaquetado de A.
+ * @param b Panel empaquetado de B.
+ * @param acc Bloque MR x NR de salida.
+ */
+template <typename T>
+inline void gemm_micro_kernel(size_t kc, const T* a, const T* b,
+                              T (&acc)[GemmBlocking<T>::MR][GemmBlocking<T>::NR]) {
+    Kernels::gemm_micro(kc, a, b, &acc[0][0]);
+}
+
+/**
+ * Epílogo vacío del GEMM: deja el resultado tal cual.
+ */
+struct GemmNoEpilogue {
+    template <typename T>
+    T operator()(size_t, size_t, T value) const { return value; }
+};
+
+/**
+ * Producto matricial general sobre bloques row-major:
+ * C = alpha * op(A) * op(B) + beta * C, donde op(X) es X o su transpuesta.
+ * Usa bloqueo por caché (paneles KC x NC de B y MC x KC de A empaquetados)
+ * y un micro-kernel con el bloque MR x NR de C en registros.
+ * El epílogo recibe (fila, columna, valor) de cada elemento terminado, justo al
+ * escribir el último bloque de k, y devuelve el valor que se guarda en C.
+ * A y B pueden guardarse en un tipo más compacto que T (por ejemplo bfloat16):
+ * se convierten al empaquetar y todo el cálculo se acumula en T.
+ * @tparam T Tipo de dato del cálculo y de C.
+ * @tparam TA Tipo de los elementos de A.
+ * @tparam TB Tipo de los elementos de B.
+ * @tparam Epilogue Función aplicada a cada elemento de C al terminar.
+ * @param trans_a Usar la transpuesta de A.
+ * @param trans_b Usar la transpuesta de B.
+ * @param m Filas de op(A) y de C.
+ * @param n Columnas de op(B) y de C.
+ * @param k Columnas de op(A) y filas de op(B).
+ * @param alpha Escala del producto.
+ * @param a Puntero a A.
+ * @param lda Distancia (en elementos) entre filas consecutivas de A.
+ * @param b Puntero a B.
+ * @param ldb Distancia entre filas consecutivas de B.
+ * @param beta Escala del contenido previo de C (0 lo ignora).
+ * @param c Puntero a C.
+ * @param ldc Distancia entre filas consecutivas de C.
+ * @param epilogue Epílogo fusionado (por defecto ninguno).
+ */
+template <typename T, typename TA, typename TB, typename Epilogue = GemmNoEpilogue>
+void gemm(bool trans_a, bool trans_b, size_t m, size_t n, size_t k,
+          T alpha, const TA* a, size_t lda, const TB* b, size_t ldb,
+          T beta, T* c, size_t ldc, Epilogue epilogue = {}) {
+    using Blocking = GemmBlocking<T>;
+    constexpr size_t MR = Blocking::MR, NR = Blocking::NR;
+    constexpr size_t KC = Blocking::KC, MC = Blocking::MC, NC = Blocking::NC;
+
+    if (m == 0 || n == 0) return;
+    if (k == 0) {
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                const T prev = (beta == static_cast<T>(0)) ? static_cast<T>(0) : beta * c[i * ldc + j];
+                c[i * ldc + j] = epilogue(i, j, prev);
+            }
+        }
+        return;
+    }
+
+    // Buffers de empaquetado reutilizados entre llamadas (uno por hilo)
+    thread_local std::vector<T, AlignedAllocator<T>> packed_a, packed_b;
+    packed_a.resize(MC * KC);
+    packed_b.resize(KC * ((std::min(NC, n) + NR - 1) / NR) * NR);
+
+    T acc[MR][NR];
+    for (size_t jc = 0; jc < n; jc += NC) {
+        const size_t nc = std::min(NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += KC) {
+            const size_t kc = std::min(KC, k - pc);
+            const bool first = (pc == 0), last = (pc + kc == k);
+            gemm_pack_b(trans_b, b, ldb, pc, jc, kc, nc, packed_b.data());
+
+            for (size_t ic = 0; ic < m; ic += MC) {
+                const size_t mc = std::min(MC, m - ic);
+                gemm_pack_a(trans_a, a, lda, ic, pc, mc, kc, packed_a.data());
+
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    const size_t cols = std::min(NR, nc - jr);
+                    for (size_t ir = 0; ir < mc; ir += MR) {
+                        const size_t rows = std::min(MR, mc - ir);
+                        gemm_micro_kernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc, acc);
+
+                        // Escribir el bloque en C (solo la parte válida en los bordes);
+                        // en el último bloque de k se aplica el epílogo antes de guardar
+                        for (size_t r = 0; r < rows; ++r) {
+                            T* c_row = c + (ic + ir + r) * ldc + jc + jr;
+                            for (size_t j = 0; j < cols; ++j) {
+                                const T prev = first ? (beta == static_cast<T>(0) ? static_cast<T>(0) : beta * c_row[j])
+                                                     : c_row[j];
+                                const T value = prev + alpha * acc[r][j];
+                                c_row[j] = last ? epilogue(ic + ir + r, jc + jr + j, value) : value;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Epílogo de capa densa: suma el sesgo de la columna y, opcionalmente, aplica
+ * ReLU y guarda la máscara (1 si z > 0) que necesita la retropropagación.
+ * @tparam T Tipo de dato.
+ */
+template <typename T>
+struct DenseEpilogue {
+    const T* bias;         // Sesgo por neurona (columna de C)
+    bool relu;             // Aplicar ReLU
+    uint8_t* mask;         // Máscara de ReLU por elemento (nullptr para omitirla)
+    size_t ldmask;         // Distancia entre filas de la máscara
+
+    T operator()(size_t i, size_t j, T value) const {
+        value += bias[j];
+        if (relu) {
+            const bool active = value > static_cast<T>(0);
+            if (mask) mask[i * ldmask + j] = active;
+            value = active ? value : static_cast<T>(0);
+        }
+        return value;
+    }
+};
+
+/**
+ * Capa densa fusionada para una muestra: out = act(W * x + b) en una sola pasada.
+ * Cada salida se calcula, recibe su sesgo y su activación mientras sigue en registro.
+ * @tparam T Tipo de dato.
+ * @param weights Pesos de la capa (una fila por neurona).
+ * @param bias Sesgo por neurona.
+ * @param input Entrada de la capa (weights.cols() elementos).
+ * @param output Salida de la capa (weights.rows() elementos).
+ * @param relu Aplicar ReLU (false deja z = W * x + b, por ejemplo para softmax).
+ * @param mask Si no es nullptr, recibe 1 donde z > 0 y 0 en otro caso.
+ * @param first Primera neurona a calcular.
+ * @param last Neurona final (exclusiva); permite repartir las filas entre hilos.
+ */
+template <typename T>
+void dense_forward(const Matrix<T>& weights, const T* bias, const T* input, T* output,
+                   bool relu, uint8_t* mask, size_t first, size_t last) {
+    const DenseEpilogue<T> epilogue{bias, relu, mask, 0};
+    for (size_t j = first; j < last; ++j) {
+        output[j] = epilogue(0, j, dot_product(weights[j].data(), input, weights.cols()));
+    }
+}
+
+template <typename T>
+void dense_forward(const Matrix<T>& weights, const T* bias, const T* input, T* output,
+                   bool relu, uint8_t* mask = nullptr) {
+    dense_forward(weights, bias, input, output, relu, mask, 0, weights.rows());
+}
+
+/**
+ * Capa densa fusionada para un lote: OUT = act(X * W^T + b), con el sesgo, la
+ * activación y la máscara aplicados en el epílogo del GEMM.
+ * @tparam T Tipo de dato del cálculo, del sesgo y de la salida.
+ * @tparam W Tipo en que se guardan los pesos.
+ * @tparam I Tipo en que se guardan las entradas.
+ * @param weights Pesos de la capa (una fila por neurona).
+ * @param bias Sesgo por neurona.
+ * @param inputs Lote de entradas (batch filas de weights.cols() elementos).
+ * @param batch Número de muestras del lote.
+ * @param outputs Lote de salidas (batch filas de weights.rows() elementos).
+ * @param relu Aplicar ReLU.
+ * @param masks Si no es nullptr, máscara de ReLU con la misma forma que outputs.
+ */
+template <typename T, typename W, typename I>
+void dense_forward_batch(const Matrix<W>& weights, const T* bias, const I* inputs, size_t batch,
+                         T* outputs, bool relu, uint8_t* masks = nullptr) {
+    const size_t in = weights.cols(), out = weights.rows();
+    gemm(false, true, batch, out, in, static_cast<T>(1), inputs, in, weights.data(), in,
+         static_cast<T>(0), outputs, out, DenseEpilogue<T>{bias, relu, masks, out});
+}
+
+/**
+ * Calcula la transposición de una matriz sobre un destino ya reservado.
+ * @tparam T Tipo de dato.
+ * @param mat Matriz original.
+ * @param result Destino con forma (mat.cols(), mat.rows()).
+ * @param pool Pool opcional; cada tarea transpone franjas de TILE filas.
+ */
+template <typename T>
+void transpose(const Matrix<T>& mat, Matrix<T>& result, ThreadPool* pool = nullptr) {
+    constexpr size_t TILE = 32; // Bloques que caben en L1 para origen y destino
+    const size_t rows = mat.rows(), cols = mat.cols();
+    if (result.rows() != cols || result.cols() != rows) {
+        throw std::invalid_argument("El destino de la transposición no tiene la forma adecuada.");
+    }
+    const size_t strips = (rows + TILE - 1) / TILE;
+    parallel_for(pool, 0, strips, 1, [&](size_t first, size_t last) {
+        for (size_t ii = first * TILE; ii < std::min(last * TILE, rows); ii += TILE) {
+            for (size_t jj = 0; jj < cols; jj += TILE) {
+                const size_t i_end = std::min(ii + TILE, rows), j_end = std::min(jj + TILE, cols);
+                for (size_t i = ii; i < i_end; ++i) {
+                    for (size_t j = jj; j < j_end; ++j) {
+                        result(j, i) = mat(i, j);
+                    }
+                }
+            }
+        }
+    });
 }
 
 /**
  * Calcula la transposición de una matriz.
  * @tparam T Tipo de dato.
  * @param mat Matriz original.
+ * @param pool Pool opcional para repartir el trabajo.
  * @return Matriz transpuesta.
  */
 template <typename T>
-Matrix<T> transpose(const Matrix<T>& mat) {
+Matrix<T> transpose(const Matrix<T>& mat, ThreadPool* pool = nullptr) {
     if (mat.empty()) return {};
-    Matrix<T> result(mat[0].size(), Vector<T>(mat.size()));
-    for (size_t i = 0; i < mat.size(); ++i) {
-        for (size_t j = 0; j < mat[0].size(); ++j) {
-            result[j][i] = mat[i][j];
-        }
-    }
+    Matrix<T> result(mat.cols(), mat.rows());
+    transpose(mat, result, pool);
     return result;
 }
 
+// Elementos por tarea al repartir apply_function entre hilos
+constexpr size_t APPLY_GRAIN = 16384;
+
 /**
  * Aplica una función a todos los elementos de un vector.
  * @tparam T Tipo de dato.
  * @param vec Vector original.
- * @param func Función a aplicar.
+ * @param func Función a aplicar (se llama desde varios hilos si hay pool).
+ * @param pool Pool opcional para repartir el trabajo.
  * @return Nuevo vector con la función aplicada.
  */
 template <typename T, typename Function>
-Vector<T> apply_function(const Vector<T>& vec, Function func) {
+Vector<T> apply_function(const Vector<T>& vec, Function func, ThreadPool* pool = nullptr) {
     Vector<T> result(vec.size());
-    for (size_t i = 0; i < vec.size(); ++i) {
-        result[i] = func(vec[i]);
-    }
+    parallel_for(pool, 0, vec.size(), APPLY_GRAIN, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            result[i] = func(vec[i]);
+        }
+    });
     return result;
 }
 
@@ -147,17 +448,20 @@ Vector<T> apply_function(const Vector<T>& vec, Function func) {
  * Aplica una función a todos los elementos de una matriz.
  * @tparam T Tipo de dato.
  * @param mat Matriz original.
- * @param func Función a aplicar.
+ * @param func Función a aplicar (se llama desde varios hilos si hay pool).
+ * @param pool Pool opcional para repartir el trabajo.
  * @return Nueva matriz con la función aplicada.
  */
 template <typename T, typename Function>
-Matrix<T> apply_function(const Matrix<T>& mat, Function func) {
-    Matrix<T> result(mat.size(), Vector<T>(mat[0].size()));
-    for (size_t i = 0; i < mat.size(); ++i) {
-        for (size_t j = 0; j < mat[0].size(); ++j) {
-            result[i][j] = func(mat[i][j]);
+Matrix<T> apply_function(const Matrix<T>& mat, Function func, ThreadPool* pool = nullptr) {
+    Matrix<T> result(mat.shape());
+    const T* src = mat.data();
+    T* dst = result.data();
+    parallel_for(pool, 0, mat.size(), APPLY_GRAIN, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            dst[i] = func(src[i]);
         }
-    }
+    });
     return result;
 }
 
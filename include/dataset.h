@@ -3,10 +3,55 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <span>
+#include <cstring>
 #include <stdexcept>
-#include "common.h" // Incluye funciones para endian conversion y file_header_t
+#include "common.h"
+#include "idx_file.h" // Archivos IDX mapeados en memoria
 
+// Validación de los archivos IDX de MNIST, compartida por Dataset y MappedDataset
+namespace Mnist {
+
+    /**
+     * Valida un archivo de imágenes MNIST (tres dimensiones: imágenes, filas y columnas).
+     * @return Vista con una fila de bytes por imagen.
+     */
+    inline MatrixView<uint8_t> image_rows(const IdxFile& file) {
+        if (file.rank() != 3) {
+            throw std::runtime_error("Error: el archivo de imágenes tiene dimensiones inválidas.");
+        }
+        return file.matrix();
+    }
+
+    /**
+     * Etiquetas de un archivo IDX de una dimensión como enteros (lo que consume la red).
+     * Admite cualquier tipo entero de IDX, no solo los bytes de MNIST.
+     */
+    inline std::vector<int> labels_from(const IdxFile& file) {
+        if (file.rank() != 1) {
+            throw std::runtime_error("Error: el archivo de etiquetas no tiene un encabezado válido.");
+        }
+        if (file.type() == IdxType::Float32 || file.type() == IdxType::Float64) {
+            throw std::runtime_error("Error: el archivo de etiquetas no contiene enteros.");
+        }
+        std::vector<int> labels(file.size());
+        file.decode_into(labels.data());
+        return labels;
+    }
+}
+
+/**
+ * Conjunto de datos MNIST (entrenamiento y prueba) cargado en memoria.
+ * Con T de coma flotante los píxeles se normalizan a [0, 1]; con T = uint8_t se
+ * guardan los bytes tal cual en un bloque contiguo, como los consume la red
+ * cuantizada (QuantizedNetwork). Los bytes ocupan 4 veces menos que float y 8
+ * menos que double, y NeuralNetwork también entrena y evalúa directamente sobre
+ * ellos: cada lote se normaliza a T con un kernel vectorial justo antes de usarlo.
+ * Los archivos se leen mapeados en memoria, sin buffers intermedios; para no
+ * copiar ni siquiera los bytes, ver MappedDataset. También admite los archivos
+ * comprimidos con gzip (.idx3-ubyte.gz), que se descomprimen al vuelo.
+ * @tparam T Tipo de los píxeles.
+ */
 template <typename T>
 class Dataset {
 private:
@@ -15,79 +60,73 @@ private:
     Matrix<T> test_images;
     std::vector<int> test_labels;
 
-    // Función privada para leer imágenes desde un archivo
-    Matrix<T> read_images(const std::string& file_path) {
-        std::ifstream file(file_path, std::ios::binary);
-        if (!file.is_open()) {
-            throw std::runtime_error("Error: no se pudo abrir el archivo de imágenes " + file_path);
-        }
-
-        // Leer encabezado
-        file_header_t header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(header));
-        header = convert_big_endian(header);
+    static constexpr size_t INFLATE_BLOCK = size_t{1} << 20; // Bytes por etapa al descomprimir
+    static constexpr size_t CONVERT_GRAIN = size_t{1} << 16; // Píxeles por tarea al normalizar
 
-        // Validar el encabezado
-        if (header.rows == 0 || header.columns == 0 || header.images == 0) {
-            throw std::runtime_error("Error: el archivo de imágenes tiene dimensiones inválidas.");
-        }
+    // Lee las imágenes de un archivo IDX mapeado o comprimido (pool opcional para decodificarlas)
+    Matrix<T> read_images(const std::string& file_path, ThreadPool* pool) {
+        if (GzipReader::is_gzip(file_path)) return read_compressed_images(file_path, pool);
+        const IdxFile file(file_path, AccessHint::Sequential);
+        const MatrixView<uint8_t> pixels = Mnist::image_rows(file);
 
-        // Leer imágenes
-        Matrix<T> images(header.images, Vector<T>(header.rows * header.columns));
-        for (auto& image : images) {
-            std::vector<uint8_t> buffer(header.rows * header.columns);
-            file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
-            if (file.gcount() != static_cast<std::streamsize>(buffer.size())) {
-                throw std::runtime_error("Error: no se pudieron leer todas las imágenes del archivo.");
-            }
-            for (size_t i = 0; i < buffer.size(); ++i) {
-                image[i] = static_cast<T>(buffer[i]) / static_cast<T>(255.0); // Normalización
+        // Una fila por imagen dentro de un único bloque contiguo, decodificada
+        // directamente desde las páginas del archivo (en paralelo si hay pool)
+        Matrix<T> images(pixels.rows(), pixels.cols());
+        parallel_for(pool, 0, images.rows(), 256, [&](size_t first, size_t last) {
+            const uint8_t* src = pixels[first].data();
+            const size_t count = (last - first) * images.cols();
+            if constexpr (std::is_same_v<T, uint8_t>) {
+                std::memcpy(images[first].data(), src, count); // Bytes en bruto, sin conversión
+            } else {
+                // Normalización con la misma conversión que se aplica a los lotes en bytes
+                Kernels::convert_u8(src, images[first].data(), count, static_cast<T>(PIXEL_SCALE));
             }
-        }
+        });
         return images;
     }
 
-    // Función privada para leer etiquetas desde un archivo
-    std::vector<int> read_labels(const std::string& file_path) {
-        std::ifstream file(file_path, std::ios::binary);
-        if (!file.is_open()) {
-            throw std::runtime_error("Error: no se pudo abrir el archivo de etiquetas " + file_path);
+    /**
+     * Descomprime las imágenes directamente al bloque final, sin archivo temporal
+     * ni copia intermedia del archivo completo. En bytes se descomprimen sobre la
+     * propia matriz; en T, un hilo descomprime el bloque siguiente mientras se
+     * normaliza el actual (repartido en el pool si lo hay).
+     */
+    Matrix<T> read_compressed_images(const std::string& file_path, ThreadPool* pool) {
+        GzipReader stream(file_path);
+        const IdxHeader header = IdxHeader::read(stream, file_path);
+        if (header.type != IdxType::UInt8 || header.dims.size() != 3) {
+            throw std::runtime_error("Error: el archivo de imágenes tiene dimensiones inválidas.");
         }
-
-        // Leer encabezado
-        uint32_t magic_number, num_items;
-        file.read(reinterpret_cast<char*>(&magic_number), sizeof(magic_number));
-        file.read(reinterpret_cast<char*>(&num_items), sizeof(num_items));
-        magic_number = to_big_endian(magic_number);
-        num_items = to_big_endian(num_items);
-
-        // Validar encabezado
-        if (magic_number != 2049) {
-            throw std::runtime_error("Error: el archivo de etiquetas no tiene un encabezado válido.");
+        Matrix<T> images(header.dims[0], header.elements / header.dims[0]);
+        if constexpr (std::is_same_v<T, uint8_t>) {
+            stream.read_exact(images.data(), header.elements);
+        } else {
+            stream.read_pipelined(header.elements, INFLATE_BLOCK, [&](const uint8_t* bytes, size_t offset, size_t count) {
+                parallel_for(pool, 0, count, CONVERT_GRAIN, [&](size_t first, size_t last) {
+                    Kernels::convert_u8(bytes + first, images.data() + offset + first, last - first,
+                                        static_cast<T>(PIXEL_SCALE));
+                });
+            });
         }
+        return images;
+    }
 
-        // Leer etiquetas
-        std::vector<int> labels(num_items);
-        for (size_t i = 0; i < num_items; ++i) {
-            uint8_t label;
-            file.read(reinterpret_cast<char*>(&label), sizeof(label));
-            if (file.gcount() != sizeof(label)) {
-                throw std::runtime_error("Error: no se pudieron leer todas las etiquetas del archivo.");
-            }
-            labels[i] = static_cast<int>(label);
-        }
-        return labels;
+    // Lee las etiquetas de un archivo IDX mapeado o comprimido
+    std::vector<int> read_labels(const std::string& file_path) {
+        return Mnist::labels_from(IdxFile(file_path, AccessHint::Sequential));
     }
 
 public:
-    // Constructor que inicializa los datos de entrenamiento y prueba
+    // Constructor que inicializa los datos de entrenamiento y prueba; con pool, la
+    // conversión de píxeles se reparte entre sus hilos
     Dataset(const std::string& train_image_path,
             const std::string& train_label_path,
             const std::string& test_image_path,
-            const std::string& test_label_path) {
-        training_images = read_images(train_image_path);
+            const std::string& test_label_path,
+            ThreadPool* pool = nullptr) {
+        training_images = read_images(train_image_path, pool);
         training_labels = read_labels(train_label_path);
-        test_images = read_images(test_image_path);
+        test_images = read_images(test_image_path, pool);
         test_labels = read_labels(test_label_path);
     }
 
@@ -98,4 +137,66 @@ public:
     const std::vector<int>& get_test_labels() const { return test_labels; }
 };
 
+/**
+ * Conjunto MNIST servido directamente desde los archivos mapeados en memoria:
+ * las imágenes y las etiquetas son vistas sobre las páginas de los archivos, así
+ * que construirlo no copia ni convierte los píxeles, y varios procesos de
+ * entrenamiento en la misma máquina comparten esas páginas en la caché del
+ * sistema. NeuralNetwork y QuantizedNetwork consumen las imágenes en bytes
+ * normalizando cada lote al usarlo. Las etiquetas se ofrecen también como
+ * enteros (una copia de 4 bytes por muestra), que es lo que recibe la red.
+ * Las vistas son válidas mientras viva el objeto.
+ */
+class MappedDataset {
+private:
+    IdxFile training_image_file;
+    IdxFile training_label_file;
+    IdxFile test_image_file;
+    IdxFile test_label_file;
+    std::vector<int> training_labels;
+    std::vector<int> test_labels;
+
+public:
+    /**
+     * Mapea los cuatro archivos IDX de MNIST (los comprimidos con gzip se descomprimen
+     * a memoria al abrirlos, así que pierden las ventajas del mapeo).
+     * @param hint Uso previsto de las imágenes de entrenamiento: Random (por
+     *             defecto) si los lotes se van a barajar, Sequential si se recorren en orden.
+     */
+    MappedDataset(const std::string& train_image_path,
+                  const std::string& train_label_path,
+                  const std::string& test_image_path,
+                  const std::string& test_label_path,
+                  AccessHint hint = AccessHint::Random)
+        : training_image_file(train_image_path, hint),
+          training_label_file(train_label_path, AccessHint::Sequential),
+          test_image_file(test_image_path, AccessHint::Sequential),
+          test_label_file(test_label_path, AccessHint::Sequential),
+          training_labels(Mnist::labels_from(training_label_file)),
+          test_labels(Mnist::labels_from(test_label_file)) {
+        if (Mnist::image_rows(training_image_file).rows() != training_labels.size() ||
+            Mnist::image_rows(test_image_file).rows() != test_labels.size()) {
+            throw std::runtime_error("Error: el número de imágenes no coincide con el de etiquetas.");
+        }
+        if (training_label_file.type() != IdxType::UInt8 || test_label_file.type() != IdxType::UInt8) {
+            throw std::runtime_error("Error: las etiquetas de MappedDataset deben ser bytes sin signo.");
+        }
+    }
+
+    // Imágenes en bytes (una fila por imagen) sobre las páginas del archivo
+    MatrixView<uint8_t> get_training_images() const { return training_image_file.matrix(); }
+    MatrixView<uint8_t> get_test_images() const { return test_image_file.matrix(); }
+
+    // Etiquetas en bytes, tal como están en el archivo
+    std::span<const uint8_t> get_training_label_bytes() const { return training_label_file.bytes(); }
+    std::span<const uint8_t> get_test_label_bytes() const { return test_label_file.bytes(); }
+
+    // Etiquetas como enteros
+    const std::vector<int>& get_training_labels() const { return training_labels; }
+    const std::vector<int>& get_test_labels() const { return test_labels; }
+
+    // true si los archivos están mapeados (false si están comprimidos o con la lectura de respaldo fuera de POSIX)
+    bool is_mapped() const { return training_image_file.is_mapped(); }
+};
+
 #endif // DATASET_H
@@ -0,0 +1,127 @@
+#ifndef GZIP_READER_H
+#define GZIP_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <semaphore>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include "tensor.h" // Para AlignedAllocator
+
+/**
+ * Lector de archivos comprimidos con gzip (o zlib) que descomprime directamente
+ * en los buffers del llamador, sin archivos temporales. El archivo comprimido se
+ * lee mapeado en memoria y admite varios miembros concatenados (como los que
+ * generan pigz o bgzip). Necesita compilarse con zlib; sin ella el constructor lanza.
+ */
+class GzipReader {
+public:
+    /**
+     * Abre un archivo comprimido.
+     * @param path Ruta del archivo.
+     * @throws std::runtime_error si no se puede abrir o la compilación no tiene zlib.
+     */
+    explicit GzipReader(const std::string& path);
+    ~GzipReader();
+
+    GzipReader(const GzipReader&) = delete;
+    GzipReader& operator=(const GzipReader&) = delete;
+
+    /**
+     * Comprueba si un archivo empieza con la firma de gzip (0x1F 0x8B), sin mirar la extensión.
+     */
+    static bool is_gzip(const std::string& path);
+
+    // true si la compilación incluye zlib
+    static bool available();
+
+    /**
+     * Cota superior de los bytes que puede producir el archivo: deflate no
+     * comprime más de 1032:1, así que una cabecera que declare más datos miente.
+     */
+    std::size_t max_size() const;
+
+    /**
+     * Descomprime hasta n bytes directamente en dst.
+     * @return Bytes escritos; menos de n solo al llegar al final de los datos.
+     * @throws std::runtime_error si los datos comprimidos están corruptos.
+     */
+    std::size_t read(std::uint8_t* dst, std::size_t n);
+
+    /**
+     * Descomprime exactamente n bytes en dst.
+     * @throws std::runtime_error si los datos terminan antes o están corruptos.
+     */
+    void read_exact(std::uint8_t* dst, std::size_t n);
+
+    /**
+     * Descomprime total bytes en bloques de block bytes con dos etapas en paralelo:
+     * un hilo propio descomprime el bloque siguiente mientras el llamador procesa
+     * el actual con f(datos, posición, tamaño). Así la conversión de los bytes (que
+     * puede repartirse en un ThreadPool) queda oculta tras la descompresión, que es
+     * secuencial por naturaleza.
+     * @param total Bytes a descomprimir.
+     * @param block Bytes por bloque (mínimo 1).
+     * @param f Función que recibe cada bloque; los datos solo son válidos durante la llamada.
+     * @throws std::runtime_error si los datos terminan antes o están corruptos.
+     */
+    template <typename Function>
+    void read_pipelined(std::size_t total, std::size_t block, const Function& f);
+
+private:
+    struct State; // Flujo de zlib y archivo comprimido mapeado
+    std::unique_ptr<State> state;
+};
+
+template <typename Function>
+void GzipReader::read_pipelined(std::size_t total, std::size_t block, const Function& f) {
+    constexpr std::size_t STAGES = 2; // Un bloque se descomprime mientras el otro se procesa
+    block = std::max<std::size_t>(std::min(block, total), 1);
+    const std::size_t blocks = (total + block - 1) / block;
+    std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>> buffers[STAGES];
+    for (auto& buffer : buffers) buffer.resize(block);
+
+    std::counting_semaphore<STAGES> free_buffers(STAGES);
+    std::counting_semaphore<STAGES> full_buffers(0);
+    std::exception_ptr producer_error;
+    std::atomic<bool> stopping{false}; // El llamador falló: el productor termina al tomar un buffer
+
+    std::thread producer([&] {
+        for (std::size_t b = 0; b < blocks; ++b) {
+            free_buffers.acquire();
+            if (stopping) return;
+            try {
+                read_exact(buffers[b % STAGES].data(), std::min(block, total - b * block));
+            } catch (...) {
+                producer_error = std::current_exception();
+                full_buffers.release();
+                return;
+            }
+            full_buffers.release();
+        }
+    });
+
+    try {
+        for (std::size_t b = 0; b < blocks; ++b) {
+            full_buffers.acquire();
+            if (producer_error) break;
+            f(buffers[b % STAGES].data(), b * block, std::min(block, total - b * block));
+            free_buffers.release();
+        }
+    } catch (...) {
+        stopping = true;
+        free_buffers.release();
+        producer.join();
+        throw;
+    }
+    producer.join();
+    if (producer_error) std::rethrow_exception(producer_error);
+}
+
+#endif // GZIP_READER_H
@@ -0,0 +1,276 @@
+#ifndef IDX_FILE_H
+#define IDX_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "tensor.h"
+#include "kernels.h"     // Lectura vectorial de valores big-endian
+#include "thread_pool.h" // Decodificación en franjas paralelas
+#include "mapped_file.h"
+#include "gzip_reader.h" // Archivos .gz descomprimidos al vuelo
+
+/**
+ * Tipo de los elementos de un archivo IDX (tercer byte de la cabecera). Los
+ * valores de más de un byte se guardan en big-endian.
+ */
+enum class IdxType : std::uint8_t {
+    UInt8 = 0x08,
+    Int8 = 0x09,
+    Int16 = 0x0B,
+    Int32 = 0x0C,
+    Float32 = 0x0D,
+    Float64 = 0x0E,
+};
+
+// Bytes por elemento de cada tipo IDX
+inline std::size_t idx_element_size(IdxType type) {
+    switch (type) {
+        case IdxType::Int16: return 2;
+        case IdxType::Int32:
+        case IdxType::Float32: return 4;
+        case IdxType::Float64: return 8;
+        default: return 1;
+    }
+}
+
+/**
+ * Cabecera de un archivo IDX (el formato de MNIST): dos bytes a cero, el tipo de
+ * dato, el número de dimensiones y cada dimensión como entero de 32 bits
+ * big-endian; después vienen los datos en orden row-major.
+ */
+struct IdxHeader {
+    // Tamaño máximo de una cabecera (255 dimensiones): basta leer este prefijo para validarla
+    static constexpr std::size_t MAX_SIZE = 4 + 4 * 255;
+
+    IdxType type = IdxType::UInt8;
+    std::vector<std::size_t> dims; // Tamaño de cada dimensión
+    std::size_t offset = 0;        // Bytes de cabecera (posición de los datos en el archivo)
+    std::size_t elements = 0;      // Número total de elementos
+
+    // Bytes de datos tras la cabecera
+    std::size_t data_bytes() const { return elements * idx_element_size(type); }
+
+    /**
+     * Valida una cabecera IDX.
+     * @param raw Prefijo del archivo con la cabecera completa (o el archivo entero).
+     * @param file_size Tamaño total del archivo, para comprobar que no está truncado
+     *                  (en un archivo comprimido, la cota de GzipReader::max_size).
+     * @param path Ruta del archivo (para los mensajes de error).
+     * @throws std::runtime_error si la cabecera no es válida o el archivo está truncado.
+     */
+    static IdxHeader parse(std::span<const std::uint8_t> raw, std::size_t file_size, const std::string& path) {
+        if (raw.size() < 4 || raw[0] != 0 || raw[1] != 0) {
+            throw std::runtime_error("Error: el archivo " + path + " no tiene una cabecera IDX válida.");
+        }
+        IdxHeader header;
+        switch (static_cast<IdxType>(raw[2])) {
+            case IdxType::UInt8:
+            case IdxType::Int8:
+            case IdxType::Int16:
+            case IdxType::Int32:
+            case IdxType::Float32:
+            case IdxType::Float64:
+                header.type = static_cast<IdxType>(raw[2]);
+                break;
+            default:
+                throw std::runtime_error("Error: el archivo " + path + " tiene un tipo de dato IDX desconocido.");
+        }
+        const std::size_t rank = raw[3];
+        header.offset = 4 + 4 * rank;
+        if (rank == 0 || raw.size() < header.offset) {
+            throw std::runtime_error("Error: el archivo " + path + " tiene dimensiones inválidas.");
+        }
+        const std::size_t element_size = idx_element_size(header.type);
+        header.elements = 1;
+        for (std::size_t axis = 0; axis < rank; ++axis) {
+            const std::uint8_t* p = raw.data() + 4 + 4 * axis;
+            const std::size_t dim = (std::size_t{p[0]} << 24) | (std::size_t{p[1]} << 16) |
+                                    (std::size_t{p[2]} << 8) | std::size_t{p[3]};
+            if (dim != 0 && header.elements > std::numeric_limits<std::size_t>::max() / element_size / dim) {
+                throw std::runtime_error("Error: el archivo " + path + " tiene dimensiones inválidas.");
+            }
+            header.dims.push_back(dim);
+            header.elements *= dim;
+        }
+        if (header.elements == 0 || file_size < header.offset || file_size - header.offset < header.data_bytes()) {
+            throw std::runtime_error("Error: el archivo " + path + " está truncado o tiene dimensiones inválidas.");
+        }
+        return header;
+    }
+
+    /**
+     * Lee y valida la cabecera de un archivo IDX sin cargar los datos.
+     * @param path Ruta del archivo.
+     * @throws std::runtime_error si no se puede abrir o la cabecera no es válida.
+     */
+    static IdxHeader read(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error: no se pudo abrir el archivo " + path);
+        }
+        const auto file_size = static_cast<std::size_t>(file.tellg());
+        std::vector<std::uint8_t> prefix(std::min(file_size, MAX_SIZE));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(prefix.data()), static_cast<std::streamsize>(prefix.size()));
+        return parse(prefix, file_size, path);
+    }
+
+    /**
+     * Lee y valida la cabecera al principio de un flujo comprimido; el flujo queda
+     * en el primer byte de los datos. Los datos declarados no pueden superar lo
+     * que el archivo comprimido es capaz de producir, así que una cabecera dañada
+     * no provoca una reserva desproporcionada antes de descubrir que está truncado.
+     * @param stream Archivo comprimido recién abierto.
+     * @param path Ruta del archivo (para los mensajes de error).
+     * @throws std::runtime_error si la cabecera no es válida o declara más datos de los posibles.
+     */
+    static IdxHeader read(GzipReader& stream, const std::string& path) {
+        std::vector<std::uint8_t> prefix(4);
+        if (stream.read(prefix.data(), prefix.size()) != prefix.size()) {
+            throw std::runtime_error("Error: el archivo " + path + " no tiene una cabecera IDX válida.");
+        }
+        prefix.resize(4 + 4 * std::size_t{prefix[3]});
+        if (stream.read(prefix.data() + 4, prefix.size() - 4) != prefix.size() - 4) {
+            throw std::runtime_error("Error: el archivo " + path + " tiene dimensiones inválidas.");
+        }
+        return parse(prefix, stream.max_size(), path);
+    }
+};
+
+/**
+ * Archivo IDX (ver IdxHeader) mapeado en memoria, de cualquier tipo y número de
+ * dimensiones. Los bytes se exponen como vistas sobre las páginas del archivo,
+ * sin copia; decode los convierte a un tensor en el orden del host.
+ * Los archivos comprimidos con gzip (reconocidos por su firma, no por la
+ * extensión) se descomprimen al abrirlos directamente a un buffer propio, sin
+ * archivos temporales; en ese caso is_mapped() es false.
+ */
+class IdxFile {
+public:
+    IdxFile() = default;
+
+    /**
+     * Mapea y valida un archivo IDX.
+     * @param path Ruta del archivo.
+     * @param hint Uso previsto de los datos (ver AccessHint).
+     * @throws std::runtime_error si la cabecera no es válida o el archivo está truncado.
+     */
+    explicit IdxFile(const std::string& path, AccessHint hint = AccessHint::Sequential) {
+        if (GzipReader::is_gzip(path)) {
+            GzipReader stream(path);
+            IdxHeader header = IdxHeader::read(stream, path);
+            inflated.resize(header.data_bytes());
+            stream.read_exact(inflated.data(), inflated.size());
+            data_type = header.type;
+            dims = std::move(header.dims);
+            payload = {inflated.data(), inflated.size()};
+            return;
+        }
+        file = MappedFile(path, hint);
+        const std::span<const std::uint8_t> raw = file.bytes();
+        IdxHeader header = IdxHeader::parse(raw, raw.size(), path);
+        data_type = header.type;
+        dims = std::move(header.dims);
+        payload = raw.subspan(header.offset, header.data_bytes());
+    }
+
+    // Tipo de los elementos
+    IdxType type() const { return data_type; }
+
+    // Tamaño de cada dimensión y número total de elementos
+    const std::vector<std::size_t>& shape() const { return dims; }
+    std::size_t rank() const { return dims.size(); }
+    std::size_t size() const { return payload.size() / idx_element_size(data_type); }
+
+    // Datos sin copia (en big-endian si los elementos ocupan más de un byte), válidos mientras viva el objeto
+    std::span<const std::uint8_t> bytes() const { return payload; }
+
+    /**
+     * Vista como matriz de bytes: la primera dimensión son las filas y el resto se
+     * aplana en columnas.
+     * @throws std::runtime_error si los elementos no son uint8 (ver decode).
+     */
+    MatrixView<std::uint8_t> matrix() const {
+        if (data_type != IdxType::UInt8) {
+            throw std::runtime_error("Error: el archivo IDX no contiene bytes sin signo.");
+        }
+        return {payload.data(), dims.empty() ? 0 : dims[0], dims.empty() ? 0 : payload.size() / dims[0]};
+    }
+
+    /**
+     * Decodifica los datos a un tensor de T con la forma del archivo.
+     * @tparam T Tipo de destino; cada valor se convierte con static_cast, sin normalizar.
+     * @param pool Pool opcional: el archivo se reparte en franjas que decodifican varios hilos.
+     */
+    template <typename T>
+    Tensor<T> decode(ThreadPool* pool = nullptr) const {
+        Tensor<T> result(dims);
+        decode_into(result.data(), pool);
+        return result;
+    }
+
+    /**
+     * Decodifica los datos a un buffer del llamador. Los valores pasan de big-endian
+     * al orden del host con un kernel vectorial (vpshufb) y, si T no es el tipo
+     * almacenado, se convierten por bloques que caben en L1.
+     * @param dst Destino (size() elementos).
+     * @param pool Pool opcional para decodificar en franjas paralelas.
+     */
+    template <typename T>
+    void decode_into(T* dst, ThreadPool* pool = nullptr) const {
+        switch (data_type) {
+            case IdxType::UInt8: decode_as<std::uint8_t>(dst, pool); break;
+            case IdxType::Int8: decode_as<std::int8_t>(dst, pool); break;
+            case IdxType::Int16: decode_as<std::int16_t>(dst, pool); break;
+            case IdxType::Int32: decode_as<std::int32_t>(dst, pool); break;
+            case IdxType::Float32: decode_as<float>(dst, pool); break;
+            case IdxType::Float64: decode_as<double>(dst, pool); break;
+        }
+    }
+
+    // Cambia el uso previsto de las páginas (por ejemplo, Random al barajar los lotes)
+    void advise(AccessHint hint) const { file.advise(hint); }
+
+    bool is_mapped() const { return file.is_mapped(); }
+
+private:
+    static constexpr std::size_t DECODE_GRAIN = std::size_t{1} << 16; // Elementos por franja paralela
+    static constexpr std::size_t DECODE_BLOCK = 1024;                  // Elementos por bloque de conversión
+
+    MappedFile file;
+    std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>> inflated; // Datos de un archivo comprimido
+    IdxType data_type = IdxType::UInt8;
+    std::vector<std::size_t> dims;
+    std::span<const std::uint8_t> payload;
+
+    template <typename Stored, typename T>
+    void decode_as(T* dst, ThreadPool* pool) const {
+        static_assert(sizeof(float) == 4 && sizeof(double) == 8, "IDX necesita float y double IEEE 754.");
+        const std::uint8_t* src = payload.data();
+        parallel_for(pool, 0, size(), DECODE_GRAIN, [&](std::size_t first, std::size_t last) {
+            if constexpr (std::is_same_v<Stored, T>) {
+                Kernels::load_big_endian(src + first * sizeof(Stored), dst + first, last - first);
+            } else if constexpr (std::is_same_v<Stored, std::uint8_t> && std::is_floating_point_v<T>) {
+                Kernels::convert_u8(src + first, dst + first, last - first, T{1});
+            } else {
+                Stored block[DECODE_BLOCK];
+                for (std::size_t i = first; i < last; i += DECODE_BLOCK) {
+                    const std::size_t count = std::min(DECODE_BLOCK, last - i);
+                    Kernels::load_big_endian(src + i * sizeof(Stored), block, count);
+                    for (std::size_t j = 0; j < count; ++j) dst[i + j] = static_cast<T>(block[j]);
+                }
+            }
+        });
+    }
+};
+
+#endif // IDX_FILE_H
@@ -0,0 +1,450 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+
+/**
+ * Biblioteca de kernels vectoriales (dot, axpy, scale, ReLU, reducciones y cuantización).
+ * Cada kernel tiene una versión portable y, en x86-64, versiones AVX2 y AVX-512
+ * compiladas en unidades de traducción separadas. La variante se elige al
+ * arrancar según CPUID, así el mismo binario aprovecha cada máquina.
+ */
+namespace Kernels {
+
+    // Conjuntos de instrucciones soportados, de menor a mayor
+    // (AVX512VNNI añade vpdpbusd para los productos de 8 bits)
+    enum class Isa { Generic, AVX2, AVX512, AVX512VNNI };
+
+    // Forma del micro-bloque del GEMM: GEMM_MR filas por una línea de caché de columnas
+    constexpr std::size_t GEMM_MR = 4;
+    template <typename T>
+    constexpr std::size_t gemm_nr = 64 / sizeof(T);
+
+    // Pesos de 8 bits empaquetados: bloques de GEMM_S8_NB neuronas por grupos de GEMM_S8_KB de k
+    constexpr std::size_t GEMM_S8_NB = 16;
+    constexpr std::size_t GEMM_S8_KB = 4;
+
+    // Bytes de una matriz de n x k pesos empaquetada (n y k se rellenan con ceros),
+    // seguida de la suma int32 de los pesos de cada neurona
+    constexpr std::size_t packed_u8s8_size(std::size_t n, std::size_t k) {
+        const std::size_t blocks = (n + GEMM_S8_NB - 1) / GEMM_S8_NB;
+        return blocks * GEMM_S8_NB * (((k + GEMM_S8_KB - 1) / GEMM_S8_KB) * GEMM_S8_KB + sizeof(std::int32_t));
+    }
+
+    /**
+     * Empaqueta n filas de k pesos int8 en el formato de gemm_u8s8: los bloques de
+     * neuronas y, detrás, la suma de los pesos de cada neurona (la variante AVX2
+     * la necesita para deshacer el desplazamiento de las activaciones).
+     * @param b Pesos (una fila por neurona), en [-127, 127].
+     * @param ldb Distancia entre filas de b.
+     * @param dst Destino de packed_u8s8_size(n, k) bytes.
+     */
+    inline void pack_u8s8(std::size_t n, std::size_t k, const std::int8_t* b, std::size_t ldb, std::int8_t* dst) {
+        const std::size_t groups = (k + GEMM_S8_KB - 1) / GEMM_S8_KB;
+        const std::size_t padded = (n + GEMM_S8_NB - 1) / GEMM_S8_NB * GEMM_S8_NB;
+        std::int8_t* sums = dst + padded * groups * GEMM_S8_KB;
+        for (std::size_t j0 = 0; j0 < n; j0 += GEMM_S8_NB) {
+            for (std::size_t g = 0; g < groups; ++g) {
+                for (std::size_t j = j0; j < j0 + GEMM_S8_NB; ++j) {
+                    for (std::size_t p = g * GEMM_S8_KB; p < (g + 1) * GEMM_S8_KB; ++p) {
+                        *dst++ = (j < n && p < k) ? b[j * ldb + p] : std::int8_t{0};
+                    }
+                }
+            }
+        }
+        for (std::size_t j = 0; j < padded; ++j) {
+            std::int32_t sum = 0;
+            for (std::size_t p = 0; j < n && p < k; ++p) sum += b[j * ldb + p];
+            std::memcpy(sums + j * sizeof(sum), &sum, sizeof(sum));
+        }
+    }
+
+    // Tabla de punteros a función de una implementación concreta
+    struct KernelTable {
+        Isa isa;
+        float (*dot_f32)(const float*, const float*, std::size_t);
+        double (*dot_f64)(const double*, const double*, std::size_t);
+        void (*axpy_f32)(float, const float*, float*, std::size_t);
+        void (*axpy_f64)(double, const double*, double*, std::size_t);
+        void (*scale_f32)(float, float*, std::size_t);
+        void (*scale_f64)(double, double*, std::size_t);
+        void (*relu_f32)(const float*, float*, std::size_t);
+        void (*relu_f64)(const double*, double*, std::size_t);
+        float (*sum_f32)(const float*, std::size_t);
+        double (*sum_f64)(const double*, std::size_t);
+        float (*max_f32)(const float*, std::size_t);
+        double (*max_f64)(const double*, std::size_t);
+        void (*row_backward_f32)(float, float, const float*, float*, float*, std::size_t);
+        void (*row_backward_f64)(double, double, const double*, double*, double*, std::size_t);
+        void (*gemm_micro_f32)(std::size_t, const float*, const float*, float*);
+        void (*gemm_micro_f64)(std::size_t, const double*, const double*, double*);
+        void (*bf16_from_f32)(const float*, std::uint16_t*, std::size_t);
+        void (*bf16_from_f32_stochastic)(const float*, std::uint16_t*, std::size_t, std::uint32_t);
+        void (*bf16_to_f32)(const std::uint16_t*, float*, std::size_t);
+        void (*gemm_u8s8)(std::size_t, std::size_t, std::size_t, const std::uint8_t*, std::size_t,
+                          const std::int8_t*, std::int32_t*, std::size_t);
+        void (*requantize_u8)(const std::int32_t*, const float*, const float*, std::uint8_t*, std::size_t);
+        float (*abs_max_f32)(const float*, std::size_t);
+        double (*abs_max_f64)(const double*, std::size_t);
+        void (*fake_quant_f32)(const float*, float*, float*, std::size_t, float, float, float);
+        void (*fake_quant_f64)(const double*, double*, double*, std::size_t, double, double, double);
+        void (*u8_to_f32)(const std::uint8_t*, float*, std::size_t, float);
+        void (*u8_to_f64)(const std::uint8_t*, double*, std::size_t, double);
+        void (*load_be16)(const std::uint8_t*, void*, std::size_t);
+        void (*load_be32)(const std::uint8_t*, void*, std::size_t);
+        void (*load_be64)(const std::uint8_t*, void*, std::size_t);
+    };
+
+    /**
+     * Detecta el mejor conjunto de instrucciones disponible en la CPU actual.
+     * Respeta la variable de entorno REDNEURONAL_ISA (generic, avx2, avx512, avx512vnni)
+     * para forzar una variante más baja.
+     */
+    Isa detect_isa();
+
+    // Tabla de la variante indicada (o de la mejor soportada por debajo de ella)
+    const KernelTable& table_for(Isa isa);
+
+    // Nombre legible de un conjunto de instrucciones
+    const char* isa_name(Isa isa);
+
+    // Puntero a la tabla activa; se inicializa una sola vez desde CPUID
+    inline const KernelTable*& active_slot() {
+        static const KernelTable* table = &table_for(detect_isa());
+        return table;
+    }
+
+    inline const KernelTable& active() { return *active_slot(); }
+
+    /**
+     * Fuerza una variante concreta (por ejemplo, para comparar en benchmarks).
+     * No es seguro llamarla mientras otros hilos ejecutan kernels.
+     * @param isa Variante deseada; si la CPU no la soporta se usa la mejor disponible.
+     */
+    void select(Isa isa);
+
+    /**
+     * Producto punto de dos bloques contiguos.
+     * @tparam T Tipo de dato.
+     * @param a Primer bloque.
+     * @param b Segundo bloque.
+     * @param n Número de elementos.
+     * @return Suma de a[i] * b[i].
+     */
+    template <typename T>
+    T dot(const T* a, const T* b, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            return active().dot_f32(a, b, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return active().dot_f64(a, b, n);
+        } else {
+            T result = 0;
+            for (std::size_t i = 0; i < n; ++i) result += a[i] * b[i];
+            return result;
+        }
+    }
+
+    /**
+     * y += alpha * x sobre bloques contiguos.
+     * @tparam T Tipo de dato.
+     */
+    template <typename T>
+    void axpy(T alpha, const T* x, T* y, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().axpy_f32(alpha, x, y, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().axpy_f64(alpha, x, y, n);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+        }
+    }
+
+    /**
+     * x *= alpha sobre un bloque contiguo.
+     * @tparam T Tipo de dato.
+     */
+    template <typename T>
+    void scale(T alpha, T* x, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().scale_f32(alpha, x, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().scale_f64(alpha, x, n);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) x[i] *= alpha;
+        }
+    }
+
+    /**
+     * out = max(0, in) elemento a elemento (in y out pueden coincidir).
+     * @tparam T Tipo de dato.
+     */
+    template <typename T>
+    void relu(const T* in, T* out, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().relu_f32(in, out, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().relu_f64(in, out, n);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) out[i] = std::max(static_cast<T>(0), in[i]);
+        }
+    }
+
+    /**
+     * Suma de los elementos de un bloque contiguo.
+     * @tparam T Tipo de dato.
+     */
+    template <typename T>
+    T sum(const T* x, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            return active().sum_f32(x, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return active().sum_f64(x, n);
+        } else {
+            T result = 0;
+            for (std::size_t i = 0; i < n; ++i) result += x[i];
+            return result;
+        }
+    }
+
+    /**
+     * Paso fusionado de retropropagación sobre una fila de pesos:
+     * acc += a * w (con w antes de actualizar) y luego w += b * x, leyendo y
+     * escribiendo cada peso una sola vez.
+     * @tparam T Tipo de dato.
+     * @param a Escala de la fila al propagar (delta de la neurona).
+     * @param b Escala de la actualización (-learning_rate * delta).
+     * @param x Activación de la capa anterior.
+     * @param w Fila de pesos (se actualiza en el lugar).
+     * @param acc Acumulador del delta de la capa anterior.
+     * @param n Número de elementos.
+     */
+    template <typename T>
+    void row_backward(T a, T b, const T* x, T* w, T* acc, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().row_backward_f32(a, b, x, w, acc, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().row_backward_f64(a, b, x, w, acc, n);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                const T weight = w[i];
+                acc[i] += a * weight;
+                w[i] = weight + b * x[i];
+            }
+        }
+    }
+
+    /**
+     * Micro-kernel del GEMM: c = suma sobre p de a[p] (columna de GEMM_MR filas)
+     * por b[p] (fila de gemm_nr<T> columnas), con los paneles ya empaquetados.
+     * @tparam T Tipo de dato.
+     * @param kc Longitud de la dimensión compartida.
+     * @param a Panel de A: kc grupos de GEMM_MR valores.
+     * @param b Panel de B: kc grupos de gemm_nr<T> valores.
+     * @param c Bloque de salida GEMM_MR x gemm_nr<T> en row-major (se sobrescribe).
+     */
+    template <typename T>
+    void gemm_micro(std::size_t kc, const T* a, const T* b, T* c) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().gemm_micro_f32(kc, a, b, c);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().gemm_micro_f64(kc, a, b, c);
+        } else {
+            constexpr std::size_t NR = gemm_nr<T>;
+            std::fill(c, c + GEMM_MR * NR, static_cast<T>(0));
+            for (std::size_t p = 0; p < kc; ++p, a += GEMM_MR, b += NR) {
+                for (std::size_t r = 0; r < GEMM_MR; ++r) {
+                    for (std::size_t j = 0; j < NR; ++j) c[r * NR + j] += a[r] * b[j];
+                }
+            }
+        }
+    }
+
+    /**
+     * Convierte floats a bfloat16 (los 16 bits altos) con redondeo al par más cercano.
+     * Los NaN siguen siendo NaN.
+     * @param src Valores de entrada.
+     * @param dst Patrones de bits bfloat16 de salida.
+     * @param n Número de elementos.
+     */
+    inline void round_to_bf16(const float* src, std::uint16_t* dst, std::size_t n) {
+        active().bf16_from_f32(src, dst, n);
+    }
+
+    /**
+     * Convierte floats a bfloat16 con redondeo estocástico: se suma ruido uniforme
+     * de 16 bits antes de truncar, así el valor esperado del resultado es el float
+     * original y las actualizaciones pequeñas no se pierden en promedio. El ruido
+     * depende solo de seed y de la posición, de modo que todas las variantes dan
+     * el mismo resultado.
+     * @param seed Semilla del ruido (usar una distinta en cada llamada).
+     */
+    inline void round_to_bf16_stochastic(const float* src, std::uint16_t* dst, std::size_t n, std::uint32_t seed) {
+        active().bf16_from_f32_stochastic(src, dst, n, seed);
+    }
+
+    /**
+     * Convierte bfloat16 a float (exacto).
+     */
+    inline void widen_bf16(const std::uint16_t* src, float* dst, std::size_t n) {
+        active().bf16_to_f32(src, dst, n);
+    }
+
+    /**
+     * Producto de matrices de 8 bits con acumulación exacta en int32: C = A * B^T,
+     * con A sin signo (activaciones cuantizadas, una fila de k bytes por muestra) y
+     * B con signo (pesos cuantizados en [-127, 127], una fila por neurona) empaquetada con
+     * pack_u8s8: bloques de GEMM_S8_NB neuronas en los que cada grupo de
+     * GEMM_S8_KB valores de k ocupa 64 bytes contiguos (neurona a neurona), el
+     * formato que consume vpdpbusd sin reducciones horizontales.
+     * @param m Filas de A y de C (muestras).
+     * @param n Neuronas (columnas de C).
+     * @param k Longitud de las filas de A.
+     * @param a Matriz A (m x k).
+     * @param lda Distancia entre filas de A.
+     * @param packed_b Pesos empaquetados con pack_u8s8(n, k).
+     * @param c Salida (m x n), se sobrescribe.
+     * @param ldc Distancia entre filas de C.
+     */
+    inline void gemm_u8s8(std::size_t m, std::size_t n, std::size_t k, const std::uint8_t* a, std::size_t lda,
+                          const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc) {
+        active().gemm_u8s8(m, n, k, a, lda, packed_b, c, ldc);
+    }
+
+    /**
+     * true si gemm_u8s8 de la variante activa supera por lotes al GEMM float de la
+     * misma variante (AVX2 y VNNI). La portable y AVX-512 sin VNNI (que usa el
+     * kernel de 256 bits frente a FMA de 512) no lo hacen.
+     */
+    inline bool fast_u8s8() {
+        const Isa isa = active().isa;
+        return isa == Isa::AVX2 || isa == Isa::AVX512VNNI;
+    }
+
+    /**
+     * Recuantiza acumuladores int32 a uint8: dst = acc * multiplier + offset,
+     * limitado a [0, 255] (lo que además aplica ReLU) y redondeado al entero más
+     * cercano (empates al par).
+     * @param acc Acumuladores de una fila (n elementos).
+     * @param multiplier Escala por elemento.
+     * @param offset Desplazamiento por elemento (sesgo ya en la escala de salida).
+     * @param dst Destino (n bytes).
+     * @param n Número de elementos.
+     */
+    inline void requantize(const std::int32_t* acc, const float* multiplier, const float* offset, std::uint8_t* dst,
+                           std::size_t n) {
+        active().requantize_u8(acc, multiplier, offset, dst, n);
+    }
+
+    /**
+     * Convierte bytes a T escalados: dst = src * scale (por ejemplo, píxeles a [0, 1]).
+     * @tparam T Tipo de dato de destino.
+     * @param src Bytes de entrada.
+     * @param dst Destino (n elementos).
+     * @param n Número de elementos.
+     * @param scale Factor por el que se multiplica cada byte.
+     */
+    template <typename T>
+    void convert_u8(const std::uint8_t* src, T* dst, std::size_t n, T scale) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().u8_to_f32(src, dst, n, scale);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().u8_to_f64(src, dst, n, scale);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>(src[i]) * scale;
+        }
+    }
+
+    /**
+     * Lee n valores big-endian sin alinear (como los de un archivo IDX) en el orden
+     * del host, invirtiendo los bytes de cada palabra con vpshufb.
+     * @tparam T Tipo de 1, 2, 4 u 8 bytes (enteros, float o double): se copian los bits.
+     * @param src Bytes de entrada (n * sizeof(T)).
+     * @param dst Destino (n elementos).
+     * @param n Número de valores.
+     */
+    template <typename T>
+    void load_big_endian(const std::uint8_t* src, T* dst, std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>, "load_big_endian copia los bits de cada valor.");
+        if constexpr (sizeof(T) == 1) {
+            std::memcpy(dst, src, n);
+        } else if constexpr (sizeof(T) == 2) {
+            active().load_be16(src, dst, n);
+        } else if constexpr (sizeof(T) == 4) {
+            active().load_be32(src, dst, n);
+        } else {
+            static_assert(sizeof(T) == 8, "load_big_endian admite palabras de 1, 2, 4 u 8 bytes.");
+            active().load_be64(src, dst, n);
+        }
+    }
+
+    /**
+     * Mayor valor absoluto de un bloque contiguo (0 si está vacío).
+     * @tparam T Tipo de dato.
+     */
+    template <typename T>
+    T abs_max(const T* x, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            return active().abs_max_f32(x, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return active().abs_max_f64(x, n);
+        } else {
+            T result = 0;
+            for (std::size_t i = 0; i < n; ++i) result = std::max(result, x[i] < 0 ? -x[i] : x[i]);
+            return result;
+        }
+    }
+
+    /**
+     * Cuantización simulada (fake quantization): dst = scale * clamp(round(src / scale), lo, hi),
+     * con redondeo al par más cercano, el mismo que usan la cuantización de los pesos
+     * y la recuantización de QuantizedNetwork. src y dst pueden coincidir.
+     * Si residual no es nulo se guarda, para el gradiente de scale, la derivada de
+     * dst / scale respecto a scale: round(v) - v dentro de [lo, hi] (nunca mayor que
+     * 1/2 en valor absoluto) y el extremo alcanzado fuera de él, con v = src / scale.
+     * @tparam T Tipo de dato.
+     * @param src Valores de entrada.
+     * @param dst Valores cuantizados (n elementos).
+     * @param residual Derivadas respecto a la escala (n elementos) o nullptr.
+     * @param n Número de elementos.
+     * @param scale Paso de la rejilla (mayor que cero).
+     * @param lo Menor nivel (-127 para pesos int8, 0 para activaciones uint8).
+     * @param hi Mayor nivel (127 o 255).
+     */
+    template <typename T>
+    void fake_quantize(const T* src, T* dst, T* residual, std::size_t n, T scale, T lo, T hi) {
+        if constexpr (std::is_same_v<T, float>) {
+            active().fake_quant_f32(src, dst, residual, n, scale, lo, hi);
+        } else if constexpr (std::is_same_v<T, double>) {
+            active().fake_quant_f64(src, dst, residual, n, scale, lo, hi);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                const T v = src[i] / scale;
+                const T r = std::min(std::max(static_cast<T>(std::nearbyint(v)), lo), hi);
+                if (residual) residual[i] = (v >= lo && v <= hi) ? r - v : r;
+                dst[i] = r * scale;
+            }
+        }
+    }
+
+    /**
+     * Máximo de un bloque contiguo no vacío.
+     * @tparam T Tipo de dato.
+     */
+    template <typename T>
+    T max(const T* x, std::size_t n) {
+        if constexpr (std::is_same_v<T, float>) {
+            return active().max_f32(x, n);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return active().max_f64(x, n);
+        } else {
+            return *std::max_element(x, x + n);
+        }
+    }
+}
+
+#endif // KERNELS_H
@@ -0,0 +1,66 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "tensor.h" // Para AlignedAllocator
+
+/**
+ * Uso previsto de las páginas de un archivo mapeado, que se comunica al kernel
+ * con madvise para ajustar la lectura anticipada.
+ * Sequential: se recorre de principio a fin (lectura anticipada agresiva).
+ * Random: accesos sin orden, como los lotes barajados (sin lectura anticipada).
+ * WillNeed: se va a usar entero pronto (empieza a cargarlo en segundo plano).
+ */
+enum class AccessHint { Sequential, Random, WillNeed };
+
+/**
+ * Archivo de solo lectura mapeado en memoria. Los bytes se leen directamente de
+ * la caché de páginas del sistema, sin copiarlos al arrancar, y varios procesos
+ * que mapean el mismo archivo comparten esas páginas. En plataformas sin mmap
+ * (fuera de POSIX) el archivo se lee entero a un buffer propio con la misma interfaz.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * Abre y mapea un archivo.
+     * @param path Ruta del archivo.
+     * @param hint Uso previsto de las páginas.
+     * @throws std::runtime_error si no se puede abrir o mapear.
+     */
+    explicit MappedFile(const std::string& path, AccessHint hint = AccessHint::Sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Contenido completo del archivo (válido mientras viva el objeto)
+    std::span<const std::uint8_t> bytes() const { return {data, length}; }
+    std::size_t size() const { return length; }
+
+    // true si los bytes son páginas mapeadas (false con la lectura de respaldo)
+    bool is_mapped() const { return mapped; }
+
+    /**
+     * Cambia el uso previsto de las páginas (sin efecto con la lectura de respaldo).
+     * @param hint Nuevo uso previsto.
+     */
+    void advise(AccessHint hint) const;
+
+private:
+    const std::uint8_t* data = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>> fallback; // Copia sin mmap
+
+    void release() noexcept;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,114 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <vector>
+#include <cstddef>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+/**
+ * Matriz de confusión de un clasificador: counts(real, predicha).
+ * De ella salen la precisión global y la precisión y exhaustividad (recall) de
+ * cada clase sin volver a recorrer el conjunto de datos. Cada hilo puede llevar
+ * la suya y combinarlas al final con merge.
+ */
+class ConfusionMatrix {
+private:
+    size_t classes = 0;
+    std::vector<size_t> counts; // classes x classes, fila = clase real
+
+public:
+    ConfusionMatrix() = default;
+
+    /**
+     * @param classes Número de clases.
+     */
+    explicit ConfusionMatrix(size_t classes) : classes(classes), counts(classes * classes, 0) {}
+
+    size_t num_classes() const { return classes; }
+
+    /**
+     * Registra una predicción.
+     * @param actual Clase real.
+     * @param predicted Clase predicha.
+     */
+    void add(int actual, int predicted) {
+        if (actual < 0 || predicted < 0 || static_cast<size_t>(actual) >= classes ||
+            static_cast<size_t>(predicted) >= classes) {
+            throw std::out_of_range("Etiqueta fuera del rango de clases.");
+        }
+        ++counts[actual * classes + predicted];
+    }
+
+    /**
+     * Suma los conteos de otra matriz con el mismo número de clases.
+     */
+    void merge(const ConfusionMatrix& other) {
+        if (other.classes != classes) {
+            throw std::invalid_argument("Las matrices de confusión tienen distinto número de clases.");
+        }
+        for (size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+    }
+
+    // Muestras con clase real actual y predicha predicted
+    size_t count(size_t actual, size_t predicted) const { return counts[actual * classes + predicted]; }
+
+    size_t total() const {
+        size_t sum = 0;
+        for (size_t value : counts) sum += value;
+        return sum;
+    }
+
+    size_t correct() const {
+        size_t sum = 0;
+        for (size_t c = 0; c < classes; ++c) sum += count(c, c);
+        return sum;
+    }
+
+    // Fracción de aciertos (0 si no hay muestras)
+    double accuracy() const {
+        const size_t n = total();
+        return n ? static_cast<double>(correct()) / n : 0.0;
+    }
+
+    // Aciertos entre las muestras predichas como c (0 si ninguna lo fue)
+    double precision(size_t c) const {
+        size_t predicted = 0;
+        for (size_t r = 0; r < classes; ++r) predicted += count(r, c);
+        return predicted ? static_cast<double>(count(c, c)) / predicted : 0.0;
+    }
+
+    // Aciertos entre las muestras cuya clase real es c (0 si no hay ninguna)
+    double recall(size_t c) const {
+        size_t actual = 0;
+        for (size_t p = 0; p < classes; ++p) actual += count(c, p);
+        return actual ? static_cast<double>(count(c, c)) / actual : 0.0;
+    }
+
+    // Media armónica de precisión y exhaustividad de la clase c
+    double f1(size_t c) const {
+        const double p = precision(c), r = recall(c);
+        return p + r > 0.0 ? 2.0 * p * r / (p + r) : 0.0;
+    }
+
+    /**
+     * Escribe una tabla con precisión, exhaustividad y F1 por clase. El formato
+     * del flujo (notación y precisión) se restaura al terminar.
+     * @param out Flujo de salida.
+     */
+    void print_report(std::ostream& out = std::cout) const {
+        const std::ios_base::fmtflags flags = out.flags();
+        const std::streamsize digits = out.precision();
+        out << "Clase  Precisión  Exhaustividad     F1" << std::endl;
+        out << std::fixed << std::setprecision(4);
+        for (size_t c = 0; c < classes; ++c) {
+            out << std::setw(5) << c << std::setw(11) << precision(c) << std::setw(15) << recall(c)
+                << std::setw(7) << f1(c) << std::endl;
+        }
+        out.flags(flags);
+        out.precision(digits);
+    }
+};
+
+#endif // METRICS_H
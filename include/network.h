@@ -7,87 +7,626 @@
 #include <stdexcept>
 #include <random>
 #include <iostream>
+#include <span>
+#include <thread>
+#include <barrier>
+#include <atomic>
+#include <limits>
 #include "common.h"   // Constantes y funciones comunes
+#include "activation.h"
+#include "workspace.h"  // Memoria de trabajo reutilizada entre pasos
+#include "metrics.h"    // Matriz de confusión para la evaluación
+#include "bfloat16.h"   // Almacenamiento compacto de precisión mixta
 
-template <typename T>
+/**
+ * Disposición en memoria de los pesos.
+ * RowMajor guarda solo W (una fila por neurona). Dual guarda además W^T para las
+ * capas que propagan delta, de modo que el producto W^T * delta de la
+ * retropropagación también recorre filas contiguas.
+ */
+enum class WeightLayout { RowMajor, Dual };
+
+/**
+ * Modo de entrenamiento con varios hilos.
+ * Synchronous reparte cada lote entre los hilos y aplica una sola actualización
+ * con los gradientes reducidos. Hogwild reparte las muestras y cada hilo actualiza
+ * los pesos compartidos sin bloqueos (estilo Hogwild!): las colisiones entre
+ * escrituras se toleran porque con entradas dispersas casi no ocurren. Hogwild
+ * no admite QAT ni, con lotes de más de una muestra, la disposición Dual.
+ */
+enum class ParallelMode { Synchronous, Hogwild };
+
+/**
+ * Perceptrón multicapa con ReLU en las capas ocultas y softmax en la salida.
+ * @tparam T Tipo de dato del cálculo y de la copia maestra de los parámetros.
+ * @tparam Storage Tipo en que el modo mini-batch guarda los pesos que leen los
+ *                 productos matriz-matriz y las activaciones ocultas del lote.
+ *                 Con Storage = bfloat16 (y T = float) se mueven la mitad de
+ *                 bytes por paso: los GEMM convierten a float al empaquetar y
+ *                 acumulan en float, y las actualizaciones se aplican a los pesos
+ *                 float, de los que se vuelve a redondear la copia compacta.
+ */
+template <typename T, typename Storage = T>
 class NeuralNetwork {
 private:
+    static_assert(std::is_same_v<Storage, T> || (std::is_same_v<Storage, bfloat16> && std::is_same_v<T, float>),
+                  "El almacenamiento compacto solo se admite como bfloat16 sobre float.");
+
+    // true si los productos por lotes leen una copia compacta de los pesos
+    static constexpr bool MIXED = !std::is_same_v<Storage, T>;
+
     std::vector<Matrix<T>> weights;     // Pesos entre las capas
     std::vector<Vector<T>> biases;      // Sesgos para cada capa
-    std::vector<Vector<T>> activations; // Salidas de activación por capa
-    std::vector<Vector<T>> z_values;    // Valores intermedios (z = wx + b)
     T learning_rate;                    // Tasa de aprendizaje
+    Workspace<T, Storage> workspace;             // Activaciones, deltas y gradientes reutilizados
+    WeightLayout layout = WeightLayout::RowMajor;
+    std::vector<Matrix<T>> weights_t;   // Copias transpuestas (modo Dual; vacía en la capa 0)
+    bool transposed_stale = false;      // weights_t no refleja los últimos pasos por lotes
+    std::vector<Workspace<T, Storage>> thread_workspaces; // Un workspace por hilo en el modo paralelo
+    ParallelMode parallel_mode = ParallelMode::Synchronous;
+    ThreadPool* pool = nullptr;         // Pool opcional (si no hay, se crean hilos por época)
+    SpinTeam* team = nullptr;           // Equipo opcional para repartir las filas en el modo por muestra
+    std::vector<Matrix<Storage>> stored_weights; // Copia en Storage de los pesos (vacía si Storage == T)
+    bool stochastic_rounding = false;   // Redondeo de la copia compacta: estocástico o al par más cercano
+    uint32_t rounding_step = 0;         // Contador para variar el ruido del redondeo estocástico
+    bool quantization_aware = false;    // Entrenamiento con cuantización simulada (QAT)
+    std::vector<Matrix<T>> quantized_weights; // Pesos en la rejilla int8 de su fila (solo en QAT)
+    std::vector<T> activation_scales;   // Escala uint8 aprendida de cada capa oculta (solo en QAT)
+
+    // Niveles de la cuantización: pesos int8 simétricos y activaciones uint8 tras ReLU
+    static constexpr T WEIGHT_LEVELS = 127;
+    static constexpr T ACTIVATION_LEVELS = 255;
+
+    static constexpr size_t INFERENCE_BLOCK = 64; // Muestras por bloque en la inferencia por lotes
+
+    struct alignas(TENSOR_ALIGNMENT) PaddedLoss { double value = 0; }; // Pérdida por hilo, sin false sharing
 
     // Métodos auxiliares
 
     /**
      * Realiza la propagación hacia adelante.
+     * La última capa deja los logits (z = wx + b); la softmax se aplica junto con
+     * la pérdida en Activation::softmax_cross_entropy. Con un SpinTeam, las neuronas
+     * de cada capa se reparten entre sus hilos y una barrera de espera activa separa
+     * las capas.
+     * @param ws Memoria de trabajo donde se guardan activaciones y máscaras.
      * @param input Entrada de la red.
-     * @return Salida de la red después de la última capa.
+     * @param split Equipo entre el que repartir las neuronas (nullptr calcula todo en este hilo).
+     * @return Logits de la red después de la última capa.
+     * @throws std::invalid_argument si el tamaño de la entrada no es el de la primera capa.
      */
-    Vector<T> forward_propagation(const Vector<T>& input) {
-        Vector<T> output = input;
-        activations.clear();
-        z_values.clear();
+    const Vector<T>& forward_propagation(Workspace<T, Storage>& ws, std::span<const T> input,
+                                         SpinTeam* split = nullptr) const {
+        if (input.size() != weights.front().cols()) {
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        if (split && split->size() > 1) {
+            split->run([&](size_t t) { forward_rows(ws, input.data(), t, split); });
+        } else {
+            forward_rows(ws, input.data(), 0, nullptr);
+        }
+        return ws.activations.back();
+    }
 
+    /**
+     * Parte part de la propagación hacia adelante por muestra: en cada capa calcula
+     * su tramo de neuronas y, con equipo, espera al resto antes de pasar a la siguiente.
+     */
+    void forward_rows(Workspace<T, Storage>& ws, const T* x, size_t part, SpinTeam* split) const {
+        const size_t parts = split ? split->size() : 1;
         for (size_t i = 0; i < weights.size(); ++i) {
-            // Calcular z = w * x + b
-            Vector<T> z(weights[i].size(), 0.0);
-            for (size_t j = 0; j < weights[i].size(); ++j) {
-                z[j] = dot_product(weights[i][j], output) + biases[i][j];
-            }
+            Vector<T>& output = ws.activations[i];
+            const size_t rows = weights[i].rows();
+            const size_t first = rows * part / parts, last = rows * (part + 1) / parts;
 
-            z_values.push_back(z);
-
-            // Aplicar función de activación (ReLU excepto en la última capa, que usa softmax)
+            // z = w * x + b y la activación en una sola pasada: ReLU (con su máscara)
+            // en las capas ocultas y logits sin activar en la última
             if (i == weights.size() - 1) {
-                output = softmax(z); // Última capa (softmax)
+                dense_forward(forward_weights(i), biases[i].data(), x, output.data(), false, nullptr, first, last);
             } else {
-                output = apply_function(z, [](T x) { return std::max(static_cast<T>(0), x); }); // ReLU
+                dense_forward(forward_weights(i), biases[i].data(), x, output.data(), true, ws.relu_masks[i].data(),
+                              first, last);
+                if (quantization_aware) {
+                    Kernels::fake_quantize(output.data() + first, output.data() + first,
+                                           ws.quant_residuals[i].data() + first, last - first, activation_scales[i],
+                                           static_cast<T>(0), ACTIVATION_LEVELS);
+                }
+                if (split) split->sync(); // La capa siguiente lee todas las salidas de esta
             }
-
-            activations.push_back(output);
+            x = output.data();
         }
-
-        return output;
     }
 
     /**
      * Realiza la retropropagación para ajustar los pesos y sesgos.
+     * El gradiente respecto a los logits debe estar en ws.deltas.back().
+     * @param ws Memoria de trabajo usada en forward_propagation.
      * @param input Entrada original.
-     * @param target Salida esperada (etiqueta codificada como un vector one-hot).
+     * @param sparse_input Si es true, la primera capa solo escribe los pesos de las
+     *                     entradas no nulas (menos colisiones en el modo Hogwild).
+     * En QAT el delta se propaga con los pesos cuantizados que usó la propagación
+     * hacia adelante, la actualización se aplica a los pesos float (paso directo o
+     * straight-through) y después se vuelven a cuantizar.
      */
-    void backward_propagation(const Vector<T>& input, const Vector<T>& target) {
-        // Gradiente de la última capa (diferencia entre salida y objetivo)
-        Vector<T> delta = activations.back();
-        for (size_t i = 0; i < delta.size(); ++i) {
-            delta[i] -= target[i];
-        }
-
+    void backward_propagation(Workspace<T, Storage>& ws, std::span<const T> input, bool sparse_input = false) {
         // Propagar hacia atrás
         for (int layer = weights.size() - 1; layer >= 0; --layer) {
-            // Actualizar pesos y sesgos
-            for (size_t i = 0; i < weights[layer].size(); ++i) {
-                for (size_t j = 0; j < weights[layer][i].size(); ++j) {
-                    weights[layer][i][j] -= learning_rate * delta[i] * (layer == 0 ? input[j] : activations[layer - 1][j]);
+            const Vector<T>& delta = ws.deltas[layer];
+            const T* prev = (layer == 0) ? input.data() : ws.activations[layer - 1].data();
+            const size_t cols = weights[layer].cols();
+
+            if (layer == 0) {
+                // Primera capa: no hay delta que propagar, solo la actualización por filas
+                if (sparse_input) {
+                    // Los pesos de entradas nulas recibirían una actualización nula: se omiten
+                    ws.nonzero_inputs.clear();
+                    for (size_t j = 0; j < cols; ++j) {
+                        if (prev[j] != 0) ws.nonzero_inputs.push_back(j);
+                    }
+                }
+                for (size_t i = 0; i < weights[layer].rows(); ++i) {
+                    const T step = -learning_rate * delta[i];
+                    T* w = weights[layer][i].data();
+                    if (sparse_input) {
+                        for (size_t j : ws.nonzero_inputs) w[j] += step * prev[j];
+                    } else {
+                        Kernels::axpy(step, prev, w, cols);
+                    }
+                    biases[layer][i] -= learning_rate * delta[i];
+                }
+                if (quantization_aware) quantize_weights(layer);
+                continue;
+            }
+
+            Vector<T>& new_delta = ws.deltas[layer - 1];
+            if (quantization_aware) {
+                // W^T * delta con los pesos cuantizados; la actualización va a los pesos float
+                const Matrix<T>& quantized = quantized_weights[layer];
+                const size_t rows = weights[layer].rows();
+                std::fill(new_delta.begin(), new_delta.end(), static_cast<T>(0));
+                for (size_t i = 0; i < rows; ++i) {
+                    Kernels::axpy(delta[i], quantized[i].data(), new_delta.data(), cols);
+                    Kernels::axpy(-learning_rate * delta[i], prev, weights[layer][i].data(), cols);
+                    biases[layer][i] -= learning_rate * delta[i];
                 }
-                biases[layer][i] -= learning_rate * delta[i];
+                if (layout == WeightLayout::Dual) {
+                    for (size_t j = 0; j < cols; ++j) {
+                        Kernels::axpy(-learning_rate * prev[j], delta.data(), weights_t[layer][j].data(), rows);
+                    }
+                }
+                quantize_weights(layer);
+            } else if (layout == WeightLayout::Dual) {
+                // new_delta[j] = fila j de W^T por delta (paso unitario), antes de actualizar;
+                // después se actualizan ambas copias, cada una recorriendo sus filas
+                Matrix<T>& wt = weights_t[layer];
+                const size_t rows = weights[layer].rows();
+                for (size_t j = 0; j < cols; ++j) {
+                    new_delta[j] = dot_product(wt[j].data(), delta.data(), rows);
+                }
+                for (size_t i = 0; i < rows; ++i) {
+                    Kernels::axpy(-learning_rate * delta[i], prev, weights[layer][i].data(), cols);
+                    biases[layer][i] -= learning_rate * delta[i];
+                }
+                for (size_t j = 0; j < cols; ++j) {
+                    Kernels::axpy(-learning_rate * prev[j], delta.data(), wt[j].data(), rows);
+                }
+            } else {
+                // Un solo recorrido por filas: cada peso se lee una vez, se usa (sin actualizar)
+                // para acumular el delta de la capa anterior y se escribe ya actualizado
+                std::fill(new_delta.begin(), new_delta.end(), static_cast<T>(0));
+                for (size_t i = 0; i < weights[layer].rows(); ++i) {
+                    Kernels::row_backward(delta[i], -learning_rate * delta[i], prev,
+                                          weights[layer][i].data(), new_delta.data(), cols);
+                    biases[layer][i] -= learning_rate * delta[i];
+                }
+            }
+            const T* residual = quantization_aware ? ws.quant_residuals[layer - 1].data() : nullptr;
+            const T scale_gradient = activation_backward(new_delta.data(), ws.relu_masks[layer - 1].data(),
+                                                         residual, cols);
+            if (quantization_aware) update_activation_scale(layer - 1, scale_gradient, cols);
+        }
+    }
+
+    /**
+     * Gradiente respecto a la salida sin activar de una capa oculta, en el lugar:
+     * derivada de ReLU y, en QAT, el paso directo del redondeo, que deja pasar el
+     * gradiente solo donde la activación no se saturó en el nivel 255 (residuo de
+     * como mucho 1/2 en valor absoluto).
+     * @param delta Gradiente respecto a la activación (n elementos); sale respecto a z.
+     * @param mask Máscara de ReLU.
+     * @param residual Residuos de fake_quantize, o nullptr fuera de QAT.
+     * @return Gradiente respecto a la escala de la activación (0 fuera de QAT).
+     */
+    static T activation_backward(T* delta, const uint8_t* mask, const T* residual, size_t n) {
+        if (!residual) {
+            for (size_t j = 0; j < n; ++j) {
+                delta[j] *= mask[j]; // Derivada de ReLU
+            }
+            return static_cast<T>(0);
+        }
+        const T scale_gradient = Kernels::dot(delta, residual, n);
+        for (size_t j = 0; j < n; ++j) {
+            delta[j] = (mask[j] && residual[j] <= static_cast<T>(0.5)) ? delta[j] : static_cast<T>(0);
+        }
+        return scale_gradient;
+    }
+
+    /**
+     * Paso de descenso sobre la escala de las activaciones de una capa oculta
+     * (Learned Step Size Quantization). El gradiente se reduce por
+     * sqrt(neuronas * 255) para que la escala avance al ritmo de los pesos; la escala
+     * se mantiene positiva.
+     * @param layer Capa oculta.
+     * @param gradient Gradiente de la pérdida respecto a la escala.
+     * @param features Neuronas de la capa.
+     */
+    void update_activation_scale(size_t layer, T gradient, size_t features) {
+        const T step = learning_rate * gradient / std::sqrt(static_cast<T>(features) * ACTIVATION_LEVELS);
+        activation_scales[layer] = std::max(activation_scales[layer] - step, std::numeric_limits<T>::epsilon());
+    }
+
+    // Pesos que usa la propagación hacia adelante: los cuantizados en QAT o los propios pesos
+    const Matrix<T>& forward_weights(size_t layer) const {
+        return quantization_aware ? quantized_weights[layer] : weights[layer];
+    }
+
+    /**
+     * Lleva cada fila de pesos de una capa a su rejilla int8 simétrica
+     * (escala = mayor |w| de la fila / 127), la misma que aplica QuantizedNetwork.
+     */
+    void quantize_weights(size_t layer) {
+        const Matrix<T>& w = weights[layer];
+        for (size_t j = 0; j < w.rows(); ++j) {
+            const T peak = Kernels::abs_max(w[j].data(), w.cols());
+            const T scale = peak > 0 ? peak / WEIGHT_LEVELS : static_cast<T>(1);
+            Kernels::fake_quantize(w[j].data(), quantized_weights[layer][j].data(), static_cast<T*>(nullptr),
+                                   w.cols(), scale, -WEIGHT_LEVELS, WEIGHT_LEVELS);
+        }
+    }
+
+    /**
+     * Propagación hacia adelante de un lote completo: Z = X * W^T + b por capa,
+     * calculado como producto matriz-matriz con sesgo, ReLU y máscara fusionados
+     * en el epílogo del GEMM. La última capa deja los logits del lote.
+     * @param ws Memoria de trabajo donde se guardan activaciones y máscaras.
+     * @param inputs Primera fila del lote (filas contiguas de tamaño igual a la entrada).
+     * @param batch Número de muestras del lote (como máximo ws.max_batch).
+     */
+    void forward_batch(Workspace<T, Storage>& ws, const T* inputs, size_t batch) const {
+        for (size_t i = 0; i < weights.size(); ++i) {
+            Matrix<T>& a = ws.batch_activations[i];
+            const bool hidden = i + 1 < weights.size();
+            uint8_t* mask = hidden ? ws.batch_masks[i].data() : nullptr;
+            if (i == 0) {
+                dense_forward_batch(batch_weights(i), biases[i].data(), inputs, batch, a.data(), hidden, mask);
+            } else {
+                dense_forward_batch(batch_weights(i), biases[i].data(), batch_input(ws, i - 1), batch, a.data(),
+                                    hidden, mask);
+            }
+            if (hidden && quantization_aware) {
+                Kernels::fake_quantize(a.data(), a.data(), ws.batch_residuals[i].data(), batch * a.cols(),
+                                       activation_scales[i], static_cast<T>(0), ACTIVATION_LEVELS);
             }
+            // La capa siguiente y la retropropagación leen la copia compacta
+            if constexpr (MIXED) {
+                if (hidden) to_bfloat16(a.data(), ws.stored_activations[i].data(), batch * a.cols());
+            }
+        }
+    }
+
+    // Pesos que leen los productos por lotes: la copia en Storage o los de forward_weights
+    const Matrix<Storage>& batch_weights(size_t layer) const {
+        if constexpr (MIXED) {
+            return stored_weights[layer];
+        } else {
+            return forward_weights(layer);
+        }
+    }
 
-            // Calcular delta para la capa anterior
+    // Activaciones de la capa oculta layer tal como las leen la capa siguiente y dW
+    const Storage* batch_input(const Workspace<T, Storage>& ws, size_t layer) const {
+        if constexpr (MIXED) {
+            return ws.stored_activations[layer].data();
+        } else {
+            return ws.batch_activations[layer].data();
+        }
+    }
+
+    /**
+     * Redondea los pesos de una capa a la copia en Storage (no hace nada si Storage == T).
+     * Con redondeo estocástico cada llamada usa ruido distinto.
+     */
+    void store_weights(size_t layer) {
+        if constexpr (MIXED) {
+            // atomic_ref: en el modo Hogwild varios hilos actualizan a la vez
+            const uint32_t step = std::atomic_ref<uint32_t>(rounding_step).fetch_add(1, std::memory_order_relaxed);
+            to_bfloat16(weights[layer].data(), stored_weights[layer].data(), weights[layer].size(),
+                        stochastic_rounding, step * static_cast<uint32_t>(weights.size()) + static_cast<uint32_t>(layer));
+        }
+    }
+
+    void store_all_weights() {
+        for (size_t layer = 0; layer < weights.size(); ++layer) store_weights(layer);
+    }
+
+    /**
+     * Retropropagación de un lote sin modificar la red: deja en ws los gradientes
+     * de pesos y sesgos sumados sobre las muestras del lote. El gradiente de la
+     * última capa (ya escalado) debe estar en ws.batch_deltas.back().
+     * @param ws Memoria de trabajo usada en forward_batch.
+     * @param inputs Primera fila del lote.
+     * @param batch Número de muestras del lote (0 deja los gradientes a cero).
+     */
+    void compute_batch_gradients(Workspace<T, Storage>& ws, const T* inputs, size_t batch) const {
+        const size_t layers = weights.size();
+
+        for (int layer = layers - 1; layer >= 0; --layer) {
+            const size_t in = weights[layer].cols(), out = weights[layer].rows();
+            const Matrix<T>& delta = ws.batch_deltas[layer];
+            Matrix<T>& weight_gradient = ws.weight_gradients[layer];
+            Vector<T>& bias_gradient = ws.bias_gradients[layer];
+
+            // dW = delta^T * A_prev, db = suma de las filas de delta
+            auto gradient_from = [&](const auto* prev) {
+                gemm(true, false, out, in, batch, static_cast<T>(1), delta.data(), out,
+                     prev, in, static_cast<T>(0), weight_gradient.data(), in);
+            };
+            if (layer == 0) {
+                gradient_from(inputs);
+            } else {
+                gradient_from(batch_input(ws, layer - 1));
+            }
+            std::fill(bias_gradient.begin(), bias_gradient.end(), static_cast<T>(0));
+            for (size_t n = 0; n < batch; ++n) {
+                Kernels::axpy(static_cast<T>(1), delta[n].data(), bias_gradient.data(), out);
+            }
+
+            // Delta de la capa anterior (los pesos aún no se han actualizado)
             if (layer > 0) {
-                Vector<T> new_delta(weights[layer][0].size(), 0.0);
-                for (size_t j = 0; j < weights[layer][0].size(); ++j) {
-                    for (size_t i = 0; i < weights[layer].size(); ++i) {
-                        new_delta[j] += delta[i] * weights[layer][i][j];
+                T* new_delta = ws.batch_deltas[layer - 1].data();
+                gemm(false, false, batch, in, out, static_cast<T>(1), delta.data(), out,
+                     batch_weights(layer).data(), in, static_cast<T>(0), new_delta, in);
+                const T* residual = quantization_aware ? ws.batch_residuals[layer - 1].data() : nullptr;
+                ws.scale_gradients[layer - 1] = activation_backward(new_delta, ws.batch_masks[layer - 1].data(),
+                                                                    residual, batch * in);
+            }
+        }
+    }
+
+    /**
+     * Aplica una actualización de descenso por gradiente con los gradientes de ws
+     * sobre los parámetros en T y vuelve a redondear la copia en Storage.
+     * La retropropagación por lotes no lee weights_t: en Dual solo se marca como
+     * desfasada y sync_transposed la rehace antes del siguiente paso por muestra.
+     * @param ws Memoria de trabajo con los gradientes acumulados.
+     */
+    void apply_gradients(const Workspace<T, Storage>& ws) {
+        for (size_t layer = 0; layer < weights.size(); ++layer) {
+            Kernels::axpy(-learning_rate, ws.weight_gradients[layer].data(), weights[layer].data(),
+                          weights[layer].size());
+            Kernels::axpy(-learning_rate, ws.bias_gradients[layer].data(), biases[layer].data(),
+                          biases[layer].size());
+            store_weights(layer);
+            if (quantization_aware) {
+                quantize_weights(layer);
+                if (layer + 1 < weights.size()) {
+                    update_activation_scale(layer, ws.scale_gradients[layer], weights[layer].rows());
+                }
+            }
+        }
+        if (layout == WeightLayout::Dual) transposed_stale = true;
+    }
+
+    // Rehace las copias transpuestas de Dual si algún paso por lotes las dejó desfasadas
+    void sync_transposed() {
+        if (!transposed_stale) return;
+        for (size_t l = 1; l < weights.size(); ++l) {
+            transpose(weights[l], weights_t[l], pool);
+        }
+        transposed_stale = false;
+    }
+
+    /**
+     * Suma los gradientes de src en dst (un paso de la reducción entre hilos).
+     */
+    static void accumulate_gradients(Workspace<T, Storage>& dst, const Workspace<T, Storage>& src) {
+        for (size_t layer = 0; layer < dst.weight_gradients.size(); ++layer) {
+            Kernels::axpy(static_cast<T>(1), src.weight_gradients[layer].data(),
+                          dst.weight_gradients[layer].data(), dst.weight_gradients[layer].size());
+            Kernels::axpy(static_cast<T>(1), src.bias_gradients[layer].data(),
+                          dst.bias_gradients[layer].data(), dst.bias_gradients[layer].size());
+        }
+        for (size_t layer = 0; layer < dst.scale_gradients.size(); ++layer) {
+            dst.scale_gradients[layer] += src.scale_gradients[layer];
+        }
+    }
+
+    /**
+     * Ejecuta worker(0..threads-1) a la vez; el hilo actual hace de worker 0. Con
+     * pool, los demás se lanzan como tareas (threads no debe superar pool->size(),
+     * porque los workers se esperan entre sí); sin pool se crean hilos nuevos.
+     */
+    template <typename Worker>
+    void run_workers(size_t threads, const Worker& worker) {
+        if (pool) {
+            TaskGroup group(*pool);
+            for (size_t t = 1; t < threads; ++t) group.run([&worker, t] { worker(t); });
+            worker(0);
+            group.wait();
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; ++t) workers.emplace_back(worker, t);
+        worker(0);
+        for (auto& w : workers) w.join();
+    }
+
+    /**
+     * Época de entrenamiento con paralelismo de datos: cada lote se reparte entre
+     * threads hilos, cada uno con su propio workspace (gradientes en buffers
+     * alineados y rellenados a línea de caché). Los gradientes se combinan con una
+     * reducción en árbol y se aplica una sola actualización por lote.
+     * @return Suma de la pérdida de todas las muestras.
+     */
+    template <typename Inputs>
+    double train_epoch_parallel(const Inputs& inputs, const std::vector<int>& labels,
+                           size_t batch_size, size_t threads) {
+        const size_t slice = (batch_size + threads - 1) / threads;
+        const size_t classes = weights.back().rows();
+        if (thread_workspaces.size() != threads || thread_workspaces[0].max_batch < slice) {
+            thread_workspaces.assign(threads, Workspace<T, Storage>(layer_sizes(), slice, quantization_aware));
+        }
+
+        std::vector<PaddedLoss> losses(threads);
+        std::barrier sync(static_cast<std::ptrdiff_t>(threads));
+
+        auto worker = [&](size_t t) {
+            Workspace<T, Storage>& ws = thread_workspaces[t];
+            for (size_t start = 0; start < inputs.rows(); start += batch_size) {
+                const size_t batch = std::min(batch_size, inputs.rows() - start);
+                const size_t begin = std::min(t * slice, batch);
+                const size_t count = std::min(slice, batch - begin);
+                const T* x = as_input(inputs.data() + (start + begin) * inputs.cols(), count * inputs.cols(),
+                                      ws.batch_inputs.data());
+
+                // Gradiente de la porción de este hilo, escalado por el lote completo
+                forward_batch(ws, x, count);
+                losses[t].value += Activation::softmax_cross_entropy(
+                        ws.batch_activations.back().data(), count, classes, labels.data() + start + begin,
+                        ws.batch_deltas.back().data(), static_cast<T>(1) / static_cast<T>(batch));
+                compute_batch_gradients(ws, x, count);
+                sync.arrive_and_wait();
+
+                // Reducción en árbol: en cada nivel, el hilo t suma el de t + stride
+                for (size_t stride = 1; stride < threads; stride *= 2) {
+                    if (t % (2 * stride) == 0 && t + stride < threads) {
+                        accumulate_gradients(ws, thread_workspaces[t + stride]);
                     }
-                    new_delta[j] *= (z_values[layer - 1][j] > 0 ? 1 : 0); // Derivada de ReLU
+                    sync.arrive_and_wait();
                 }
-                delta = new_delta;
+
+                if (t == 0) apply_gradients(ws);
+                sync.arrive_and_wait();
             }
+        };
+
+        run_workers(threads, worker);
+
+        double total_loss = 0;
+        for (const auto& loss : losses) total_loss += loss.value;
+        return total_loss;
+    }
+
+    /**
+     * Época de entrenamiento asíncrona (Hogwild): cada hilo recorre su propio tramo
+     * contiguo de muestras y aplica sus actualizaciones directamente sobre los pesos
+     * y sesgos compartidos, sin bloqueos ni barreras. Solo son benignas las carreras
+     * de las actualizaciones peso a peso (axpy sobre W, los sesgos y, por muestra,
+     * W^T de Dual): como mucho se pierde alguna, lo que el descenso estocástico
+     * tolera. Las reescrituras de matrices enteras derivadas de los pesos (la W^T
+     * de Dual tras un lote, la cuantización de QAT y sus escalas) no lo son, así que
+     * train_epoch rechaza esas combinaciones. Con lotes de una muestra la primera
+     * capa solo toca los pesos de los píxeles no nulos.
+     * @return Suma de la pérdida de todas las muestras.
+     */
+    template <typename Inputs>
+    double train_epoch_hogwild(const Inputs& inputs, const std::vector<int>& labels,
+                          size_t batch_size, size_t threads) {
+        if (thread_workspaces.size() != threads || thread_workspaces[0].max_batch < batch_size) {
+            thread_workspaces.assign(threads, Workspace<T, Storage>(layer_sizes(), batch_size, quantization_aware));
+        }
+
+        std::vector<PaddedLoss> losses(threads);
+        const size_t samples = inputs.rows();
+
+        auto worker = [&](size_t t) {
+            Workspace<T, Storage>& ws = thread_workspaces[t];
+            const size_t first = samples * t / threads, last = samples * (t + 1) / threads;
+            for (size_t start = first; start < last; start += batch_size) {
+                const size_t batch = std::min(batch_size, last - start);
+                const T* x = as_input(inputs[start].data(), batch * inputs.cols(), ws.batch_inputs.data());
+                losses[t].value += train_step(ws, x, &labels[start], batch, true);
+            }
+        };
+
+        run_workers(threads, worker);
+
+        double total_loss = 0;
+        for (const auto& loss : losses) total_loss += loss.value;
+        return total_loss;
+    }
+
+    /**
+     * Paso de entrenamiento sobre la memoria de trabajo indicada.
+     * @param ws Memoria de trabajo (con capacidad para batch muestras).
+     * @param concurrent true si otros hilos entrenan a la vez (Hogwild): no se usa el
+     *                   SpinTeam y la primera capa omite los pesos de entradas nulas.
+     * @return Suma de la pérdida de las muestras del lote.
+     */
+    T train_step(Workspace<T, Storage>& ws, const T* inputs, const int* labels, size_t batch, bool concurrent) {
+        const size_t classes = weights.back().rows();
+        const size_t input_size = weights.front().cols();
+        if (batch == 1) {
+            const Vector<T>& logits = forward_propagation(ws, {inputs, input_size}, concurrent ? nullptr : team);
+
+            // Pérdida y gradiente de salida en una pasada
+            const T loss = Activation::softmax_cross_entropy(logits.data(), 1, classes, labels,
+                                                             ws.deltas.back().data(), static_cast<T>(1));
+            sync_transposed(); // Por ejemplo, tras los lotes completos de una época con resto de una muestra
+            backward_propagation(ws, {inputs, input_size}, concurrent);
+            return loss;
+        }
+
+        forward_batch(ws, inputs, batch);
+
+        // Pérdida del lote y gradiente promedio respecto a los logits
+        const T loss = Activation::softmax_cross_entropy(
+                ws.batch_activations.back().data(), batch, classes, labels,
+                ws.batch_deltas.back().data(), static_cast<T>(1) / static_cast<T>(batch));
+        compute_batch_gradients(ws, inputs, batch);
+        apply_gradients(ws);
+        return loss;
+    }
+
+    /**
+     * Bloque de entradas como T: el propio bloque si ya es de tipo T; si son bytes
+     * se normalizan a [0, 1] en buffer (con sitio para elements valores), de modo
+     * que solo el lote en uso ocupa memoria en T.
+     * @param rows Primera fila del bloque.
+     * @param elements Número de valores del bloque.
+     * @param buffer Destino de la conversión.
+     */
+    template <typename In>
+    static const T* as_input(const In* rows, size_t elements, T* buffer) {
+        static_assert(std::is_same_v<In, T> || std::is_same_v<In, uint8_t>,
+                      "Las entradas deben ser del tipo de la red o bytes (uint8_t).");
+        if constexpr (std::is_same_v<In, T>) {
+            return rows;
+        } else {
+            Kernels::convert_u8(rows, buffer, elements, static_cast<T>(PIXEL_SCALE));
+            return buffer;
         }
     }
 
+    // Índice de la mayor salida (clase predicha)
+    static int argmax(std::span<const T> output) {
+        return std::distance(output.begin(), std::max_element(output.begin(), output.end()));
+    }
+
+    // Mayor número de neuronas de una capa (sin contar la entrada)
+    size_t max_layer_width() const {
+        size_t width = 0;
+        for (const auto& w : weights) width = std::max(width, w.rows());
+        return width;
+    }
+
+    // Neuronas por capa, incluida la entrada
+    std::vector<size_t> layer_sizes() const {
+        std::vector<size_t> sizes{weights[0].cols()};
+        for (const auto& w : weights) sizes.push_back(w.rows());
+        return sizes;
+    }
+
 public:
     /**
      * Constructor de la red neuronal.
@@ -95,68 +634,471 @@ public:
      * @param learning_rate Tasa de aprendizaje.
      */
     NeuralNetwork(const std::vector<int>& architecture, T learning_rate) : learning_rate(learning_rate) {
+        if (architecture.size() < 2) {
+            throw std::invalid_argument("La arquitectura necesita al menos una capa de entrada y una de salida.");
+        }
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_real_distribution<T> dis(-0.5, 0.5);
 
         for (size_t i = 1; i < architecture.size(); ++i) {
-            weights.emplace_back(Matrix<T>(architecture[i], Vector<T>(architecture[i - 1])));
+            weights.emplace_back(architecture[i], architecture[i - 1]); // Un bloque contiguo por capa
             biases.emplace_back(Vector<T>(architecture[i], 0.0));
-            for (auto& row : weights.back()) {
-                for (auto& weight : row) {
-                    weight = dis(gen); // Inicializar pesos aleatorios
-                }
+            for (auto& weight : weights.back()) {
+                weight = dis(gen); // Inicializar pesos aleatorios
+            }
+        }
+        workspace = Workspace<T, Storage>(layer_sizes(), 1);
+        if constexpr (MIXED) {
+            for (const auto& w : weights) stored_weights.emplace_back(w.rows(), w.cols());
+            store_all_weights();
+        }
+    }
+
+    /**
+     * Ejecuta un paso de entrenamiento (una actualización de los parámetros).
+     * Con batch == 1 es SGD por muestra; con lotes mayores usa productos matriz-matriz.
+     * No reserva memoria si batch no supera la capacidad ya reservada con reserve_batch.
+     * Con Storage compacto, el paso por muestra actualiza los pesos en T y después
+     * redondea la copia completa; train_epoch lo hace una sola vez por época.
+     * @param inputs Primera fila del lote (batch filas contiguas).
+     * @param labels Etiqueta de cada muestra del lote.
+     * @param batch Número de muestras del lote.
+     * @return Suma de la pérdida (Cross-Entropy Loss) de las muestras del lote.
+     */
+    T train_step(const T* inputs, const int* labels, size_t batch) {
+        workspace.reserve_batch(batch);
+        const T loss = train_step(workspace, inputs, labels, batch, false);
+        if (batch == 1) store_all_weights();
+        return loss;
+    }
+
+    /**
+     * Elige la disposición de los pesos. Dual crea (o libera) las copias transpuestas.
+     * @param new_layout Disposición deseada.
+     */
+    void set_weight_layout(WeightLayout new_layout) {
+        layout = new_layout;
+        weights_t.clear();
+        if (layout == WeightLayout::Dual) {
+            weights_t.resize(weights.size());
+            for (size_t l = 1; l < weights.size(); ++l) {
+                weights_t[l] = transpose(weights[l], pool);
+            }
+        }
+        transposed_stale = false;
+    }
+
+    WeightLayout get_weight_layout() const { return layout; }
+
+    // Parámetros de cada capa (por ejemplo, para cuantizar la red con QuantizedNetwork)
+    const std::vector<Matrix<T>>& get_weights() const { return weights; }
+    const std::vector<Vector<T>>& get_biases() const { return biases; }
+
+    /**
+     * Elige cómo se reparte el entrenamiento cuando se usan varios hilos.
+     * @param mode Synchronous (reducción de gradientes por lote) o Hogwild (asíncrono sin
+     *             bloqueos; sin QAT y, con lotes mayores que 1, sin la disposición Dual).
+     */
+    void set_parallel_mode(ParallelMode mode) { parallel_mode = mode; }
+
+    ParallelMode get_parallel_mode() const { return parallel_mode; }
+
+    /**
+     * Usa un pool de hilos para el entrenamiento con varios hilos y para evaluate.
+     * El pool debe vivir más que su uso por la red; nullptr vuelve a crear hilos por época.
+     * @param thread_pool Pool a usar (no se toma su propiedad).
+     */
+    void set_thread_pool(ThreadPool* thread_pool) { pool = thread_pool; }
+
+    /**
+     * Elige cómo se redondean los pesos a la copia en Storage tras cada
+     * actualización. El redondeo estocástico conserva en promedio las
+     * actualizaciones menores que la precisión de bfloat16; el redondeo al par más
+     * cercano es determinista. Sin efecto si Storage == T.
+     * @param enabled true para redondeo estocástico.
+     */
+    void set_stochastic_rounding(bool enabled) { stochastic_rounding = enabled; }
+
+    bool get_stochastic_rounding() const { return stochastic_rounding; }
+
+    /**
+     * Mayor activación de cada capa oculta sobre una muestra de entradas
+     * (repartida por todo el conjunto para cubrir todas las clases). Es la
+     * calibración de la cuantización: la escala uint8 de cada capa es su rango / 255.
+     * @param inputs Entradas (una fila por muestra; T o bytes).
+     * @param samples Número de muestras a propagar.
+     * @return Un rango por capa oculta.
+     */
+    template <typename Inputs>
+    std::vector<T> activation_ranges(const Inputs& inputs, size_t samples) const {
+        if (inputs.rows() == 0 || inputs.cols() != weights.front().cols()) {
+            throw std::invalid_argument("Las entradas de calibración no coinciden con la primera capa.");
+        }
+        samples = std::clamp<size_t>(samples, 1, inputs.rows());
+        const size_t stride = inputs.rows() / samples;
+
+        std::vector<T> ranges(weights.size() - 1, static_cast<T>(0));
+        Matrix<T> batch(INFERENCE_BLOCK, inputs.cols());
+        std::vector<Matrix<T>> outputs;
+        for (const auto& w : weights) outputs.emplace_back(INFERENCE_BLOCK, w.rows());
+        for (size_t start = 0; start < samples; start += INFERENCE_BLOCK) {
+            const size_t count = std::min(INFERENCE_BLOCK, samples - start);
+            for (size_t k = 0; k < count; ++k) {
+                const auto* row = inputs[(start + k) * stride].data();
+                const T* values = as_input(row, inputs.cols(), batch[k].data()); // Los bytes se convierten en su sitio
+                if (values != batch[k].data()) std::copy_n(values, inputs.cols(), batch[k].data());
             }
+            const T* x = batch.data();
+            for (size_t l = 0; l + 1 < weights.size(); ++l) {
+                dense_forward_batch(weights[l], biases[l].data(), x, count, outputs[l].data(), true);
+                ranges[l] = std::max(ranges[l], Kernels::max(outputs[l].data(), count * weights[l].rows()));
+                x = outputs[l].data();
+            }
+        }
+        return ranges;
+    }
+
+    /**
+     * Activa el entrenamiento con cuantización simulada (QAT) para que la red
+     * llegue ajustada al motor int8 de QuantizedNetwork. Desde ese momento la
+     * propagación hacia adelante usa pesos cuantizados a int8 por fila y
+     * activaciones ocultas cuantizadas a uint8 con una escala por capa, y la
+     * retropropagación pasa el gradiente a través del redondeo (straight-through)
+     * y aprende además esas escalas. Las escalas parten de una calibración como la
+     * de la cuantización posterior al entrenamiento. Se supone que la entrada ya
+     * está en la rejilla de 1/255 que produce Dataset. Solo con Storage == T.
+     * @param calibration Entradas (T o bytes) con las que se inicializan las escalas.
+     * @param calibration_samples Muestras de calibración, repartidas por todo el conjunto.
+     */
+    template <typename Inputs>
+    void enable_quantization_aware(const Inputs& calibration, size_t calibration_samples = 1024) {
+        if constexpr (MIXED) {
+            throw std::invalid_argument("El entrenamiento con cuantización simulada requiere Storage == T.");
         }
+        activation_scales = activation_ranges(calibration, calibration_samples);
+        for (T& scale : activation_scales) scale = scale > 0 ? scale / ACTIVATION_LEVELS : static_cast<T>(1);
+        quantized_weights.clear();
+        for (const auto& w : weights) quantized_weights.emplace_back(w.rows(), w.cols());
+        quantization_aware = true;
+        for (size_t layer = 0; layer < weights.size(); ++layer) quantize_weights(layer);
+        workspace = Workspace<T, Storage>(layer_sizes(), std::max<size_t>(workspace.max_batch, 1), true);
+        thread_workspaces.clear();
+    }
+
+    /**
+     * Vuelve al entrenamiento en coma flotante; los pesos float se conservan.
+     */
+    void disable_quantization_aware() {
+        quantization_aware = false;
+        quantized_weights.clear();
+        activation_scales.clear();
+        workspace = Workspace<T, Storage>(layer_sizes(), std::max<size_t>(workspace.max_batch, 1));
+        thread_workspaces.clear();
+    }
+
+    bool get_quantization_aware() const { return quantization_aware; }
+
+    // Escalas uint8 aprendidas de las capas ocultas (vacío fuera de QAT)
+    const std::vector<T>& get_activation_scales() const { return activation_scales; }
+
+    /**
+     * Reparte las neuronas de cada capa entre los hilos de un SpinTeam en la
+     * propagación por muestra (predict y train con lotes de una muestra), para
+     * reducir la latencia de una sola inferencia. El equipo debe vivir más que su
+     * uso por la red y no debe compartirse entre llamadas concurrentes.
+     * @param spin_team Equipo a usar (no se toma su propiedad); nullptr vuelve al modo de un hilo.
+     */
+    void set_spin_team(SpinTeam* spin_team) { team = spin_team; }
+
+    /**
+     * Reserva la memoria de trabajo para lotes de hasta batch_size muestras.
+     * @param batch_size Tamaño máximo de lote.
+     */
+    void reserve_batch(size_t batch_size) { workspace.reserve_batch(batch_size); }
+
+    /**
+     * Recorre una vez el conjunto de entrenamiento.
+     * @tparam Inputs Matrix o MatrixView (por ejemplo, de un MappedDataset) de T o de
+     *                bytes; los bytes se normalizan a [0, 1] lote a lote.
+     * @param inputs Entradas de entrenamiento (una fila por muestra).
+     * @param labels Etiqueta entera de cada muestra.
+     * @param batch_size Muestras por actualización.
+     * @param threads Hilos de entrenamiento (1 entrena en el hilo actual); el reparto
+     *                depende del modo elegido con set_parallel_mode.
+     * @return Pérdida media de la época.
+     * @throws std::invalid_argument si el tamaño de las entradas no es el de la primera capa,
+     *         o si Hogwild con varios hilos se combina con QAT o con Dual y lotes mayores que 1.
+     */
+    template <typename Inputs>
+    T train_epoch(const Inputs& inputs, const std::vector<int>& labels, size_t batch_size, size_t threads = 1) {
+        if (batch_size == 0 || threads == 0) {
+            throw std::invalid_argument("El tamaño de lote y el número de hilos deben ser mayores que cero.");
+        }
+        if (inputs.cols() != weights.front().cols()) {
+            // train_step lee filas de ese ancho sin comprobarlo (y el GEMM empaqueta el lote entero)
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        if (threads > 1 && parallel_mode == ParallelMode::Hogwild &&
+            (quantization_aware || (layout == WeightLayout::Dual && batch_size > 1))) {
+            // Cada paso reescribiría sin sincronizar matrices enteras que leen los demás hilos
+            throw std::invalid_argument("Hogwild no admite QAT ni la disposición Dual con lotes mayores que 1.");
+        }
+        if (labels.size() != inputs.rows()) {
+            throw std::invalid_argument("El número de etiquetas no coincide con el de entradas.");
+        }
+        const int classes = static_cast<int>(weights.back().rows());
+        for (int label : labels) {
+            if (label < 0 || label >= classes) {
+                throw std::out_of_range("Etiqueta fuera del rango de clases.");
+            }
+        }
+
+        if (batch_size == 1) sync_transposed(); // Antes de repartir entre hilos, no dentro de cada uno
+        if (pool) threads = std::min(threads, pool->size()); // Los workers se esperan: uno por hilo del pool
+        double total_loss = 0.0; // En double para no perder precisión con T = float
+        if (threads > 1 && parallel_mode == ParallelMode::Hogwild) {
+            total_loss = train_epoch_hogwild(inputs, labels, batch_size, std::min(threads, inputs.rows()));
+        } else if (threads > 1 && batch_size > 1) {
+            total_loss = train_epoch_parallel(inputs, labels, batch_size, std::min(threads, batch_size));
+        } else {
+            reserve_batch(batch_size); // Única reserva: los pasos siguientes reutilizan el workspace
+            for (size_t start = 0; start < inputs.rows(); start += batch_size) {
+                const size_t batch = std::min(batch_size, inputs.rows() - start);
+                const T* x = as_input(inputs[start].data(), batch * inputs.cols(), workspace.batch_inputs.data());
+                total_loss += train_step(workspace, x, &labels[start], batch, false);
+            }
+        }
+        // Los pasos por muestra (y Hogwild) solo actualizan los pesos en T
+        if (batch_size == 1 || parallel_mode == ParallelMode::Hogwild) store_all_weights();
+        return static_cast<T>(total_loss / inputs.rows());
     }
 
     /**
      * Entrena la red neuronal con el dataset proporcionado.
-     * @param inputs Entradas de entrenamiento.
-     * @param labels Etiquetas (en formato one-hot).
+     * @param inputs Entradas de entrenamiento (una fila por muestra; T o bytes, ver train_epoch).
+     * @param labels Etiqueta entera de cada muestra.
+     * @param epochs Número de épocas de entrenamiento.
+     * @param batch_size Muestras por actualización; 1 es SGD por muestra y valores
+     *                   mayores procesan cada lote con productos matriz-matriz.
+     * @param threads Hilos de entrenamiento (ver set_parallel_mode).
+     * @throws std::invalid_argument si el tamaño de las entradas no es el de la primera capa.
+     */
+    template <typename Inputs>
+    void train(const Inputs& inputs, const std::vector<int>& labels, int epochs,
+               size_t batch_size = 1, size_t threads = 1) {
+        if (inputs.cols() != weights.front().cols()) {
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        for (int epoch = 0; epoch < epochs; ++epoch) {
+            const T loss = train_epoch(inputs, labels, batch_size, threads);
+            std::cout << "Época " << epoch + 1 << ": Pérdida = " << loss << std::endl;
+        }
+    }
+
+    /**
+     * Recorre una vez un conjunto que se lee por bloques desde disco (StreamingDataset).
+     * Cada tanda de muestras barajadas se entrena con train_epoch mientras se leen
+     * los bloques siguientes, así que la memoria no depende del tamaño del conjunto.
+     * @tparam Stream Fuente con for_each_chunk(batch_size, f), como StreamingDataset.
+     * @param stream Conjunto de entrenamiento.
+     * @param batch_size Muestras por actualización.
+     * @param threads Hilos de entrenamiento (ver set_parallel_mode).
+     * @return Pérdida media de la época.
+     */
+    template <typename Stream>
+    T train_epoch(Stream& stream, size_t batch_size, size_t threads = 1) {
+        double total_loss = 0.0;
+        size_t seen = 0;
+        stream.for_each_chunk(batch_size, [&](const auto& inputs, const std::vector<int>& labels) {
+            total_loss += static_cast<double>(train_epoch(inputs, labels, batch_size, threads)) * inputs.rows();
+            seen += inputs.rows();
+        });
+        return static_cast<T>(total_loss / std::max<size_t>(seen, 1));
+    }
+
+    /**
+     * Entrena la red con un conjunto leído por bloques desde disco (ver train_epoch).
+     * @param stream Conjunto de entrenamiento (StreamingDataset).
      * @param epochs Número de épocas de entrenamiento.
+     * @param batch_size Muestras por actualización.
+     * @param threads Hilos de entrenamiento (ver set_parallel_mode).
      */
-    void train(const std::vector<Vector<T>>& inputs, const std::vector<Vector<T>>& labels, int epochs) {
+    template <typename Stream>
+    void train(Stream& stream, int epochs, size_t batch_size = 1, size_t threads = 1) {
         for (int epoch = 0; epoch < epochs; ++epoch) {
-            T total_loss = 0.0;
-            for (size_t i = 0; i < inputs.size(); ++i) {
-                Vector<T> output = forward_propagation(inputs[i]);
-                backward_propagation(inputs[i], labels[i]);
-
-                // Calcular pérdida (Cross-Entropy Loss)
-                for (size_t j = 0; j < labels[i].size(); ++j) {
-                    total_loss -= labels[i][j] * std::log(output[j] + EPSILON);
+            const T loss = train_epoch(stream, batch_size, threads);
+            std::cout << "Época " << epoch + 1 << ": Pérdida = " << loss << std::endl;
+        }
+    }
+
+    /**
+     * Crea memoria de trabajo para infer y predict_batch dimensionada para esta red.
+     * @param batch Muestras por bloque en predict_batch (1 basta para infer).
+     * @return Scratch que el llamador conserva y reutiliza entre inferencias.
+     */
+    InferenceScratch<T> make_inference_scratch(size_t batch = 1) const {
+        return InferenceScratch<T>(layer_sizes(), batch);
+    }
+
+    /**
+     * Inferencia de solo lectura: calcula los logits de una entrada usando únicamente
+     * la memoria del llamador y sin guardar máscaras ni activaciones de entrenamiento.
+     * Varios hilos pueden llamarla a la vez sobre la misma red, cada uno con su
+     * propio scratch, mientras nadie la entrene. En QAT usa los pesos y las
+     * activaciones cuantizados.
+     * @param input Entrada de la red.
+     * @param scratch Memoria de trabajo del llamador (ver make_inference_scratch).
+     * @return Logits de la entrada, válidos hasta el siguiente uso de scratch.
+     */
+    std::span<const T> infer(std::span<const T> input, InferenceScratch<T>& scratch) const {
+        if (input.size() != weights.front().cols()) {
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        if (scratch.batch == 0 || scratch.width < max_layer_width()) {
+            throw std::invalid_argument("La memoria de inferencia es demasiado pequeña para esta red.");
+        }
+        const T* x = input.data();
+        T* out = scratch.front.data();
+        T* other = scratch.back.data();
+        for (size_t i = 0; i < weights.size(); ++i) {
+            dense_forward(forward_weights(i), biases[i].data(), x, out, i + 1 < weights.size());
+            if (quantization_aware && i + 1 < weights.size()) {
+                Kernels::fake_quantize(out, out, static_cast<T*>(nullptr), weights[i].rows(), activation_scales[i],
+                                       static_cast<T>(0), ACTIVATION_LEVELS);
+            }
+            x = out;
+            std::swap(out, other); // Las capas alternan entre los dos buffers
+        }
+        return {x, weights.back().rows()};
+    }
+
+    /**
+     * Predice la etiqueta de una entrada sin modificar la red (ver infer).
+     * @param input Entrada de la red.
+     * @param scratch Memoria de trabajo del llamador.
+     * @return Etiqueta predicha.
+     */
+    int predict(std::span<const T> input, InferenceScratch<T>& scratch) const {
+        return argmax(infer(input, scratch));
+    }
+
+    /**
+     * Predice las etiquetas de n entradas contiguas sin modificar la red. Las
+     * muestras se propagan en bloques de scratch.batch filas con productos
+     * matriz-matriz, y cada etiqueta es el argmax directo de los logits (la
+     * softmax no cambia el orden, así que no se calcula). Con Storage compacto se
+     * usa la copia compacta de los pesos, igual que en el entrenamiento por lotes,
+     * y en QAT se simula la cuantización como al entrenar. Las entradas en bytes se
+     * normalizan bloque a bloque en el scratch.
+     * @param inputs Primera fila del bloque (n filas contiguas del tamaño de la entrada, T o bytes).
+     * @param n Número de muestras.
+     * @param out Etiqueta predicha de cada muestra (n elementos).
+     * @param scratch Memoria de trabajo del llamador (ver make_inference_scratch).
+     */
+    template <typename In>
+    void predict_batch(const In* inputs, size_t n, int* out, InferenceScratch<T>& scratch) const {
+        if (scratch.batch == 0 || scratch.width < max_layer_width()) {
+            throw std::invalid_argument("La memoria de inferencia es demasiado pequeña para esta red.");
+        }
+        const size_t input_size = weights.front().cols(), classes = weights.back().rows();
+        for (size_t start = 0; start < n; start += scratch.batch) {
+            const size_t batch = std::min(scratch.batch, n - start);
+            const T* x = as_input(inputs + start * input_size, batch * input_size, scratch.inputs.data());
+            T* a = scratch.front.data();
+            T* b = scratch.back.data();
+            for (size_t i = 0; i < weights.size(); ++i) {
+                dense_forward_batch(batch_weights(i), biases[i].data(), x, batch, a, i + 1 < weights.size());
+                if (quantization_aware && i + 1 < weights.size()) {
+                    Kernels::fake_quantize(a, a, static_cast<T*>(nullptr), batch * weights[i].rows(),
+                                           activation_scales[i], static_cast<T>(0), ACTIVATION_LEVELS);
                 }
+                x = a;
+                std::swap(a, b);
+            }
+            for (size_t k = 0; k < batch; ++k) {
+                out[start + k] = argmax({x + k * classes, classes});
             }
-            std::cout << "Época " << epoch + 1 << ": Pérdida = " << total_loss / inputs.size() << std::endl;
         }
     }
 
     /**
-     * Evalúa la red neuronal en un conjunto de prueba.
-     * @param inputs Entradas de prueba.
+     * Versión de predict_batch que reserva su propia memoria de trabajo.
+     */
+    template <typename In>
+    void predict_batch(const In* inputs, size_t n, int* out) const {
+        InferenceScratch<T> scratch = make_inference_scratch(std::max<size_t>(1, std::min(n, INFERENCE_BLOCK)));
+        predict_batch(inputs, n, out, scratch);
+    }
+
+    /**
+     * Clasifica un conjunto de prueba y acumula la matriz de confusión, de la que
+     * salen la precisión global y las métricas por clase en una sola pasada.
+     * Las muestras se clasifican por bloques con predict_batch; con pool
+     * (set_thread_pool) cada hilo acumula su propia matriz y se combinan al final.
+     * @param inputs Entradas de prueba (una fila por muestra; T o bytes).
      * @param labels Etiquetas correspondientes.
-     * @return Precisión de la red en el conjunto de prueba.
+     * @return Matriz de confusión (filas: clase real; columnas: clase predicha).
+     * @throws std::invalid_argument si el tamaño de las entradas no es el de la primera capa.
      */
-    double evaluate(const std::vector<Vector<T>>& inputs, const std::vector<int>& labels) {
-        int correct = 0;
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            int predicted = predict(inputs[i]);
-            if (predicted == labels[i]) {
-                ++correct;
+    template <typename Inputs>
+    ConfusionMatrix confusion_matrix(const Inputs& inputs, const std::vector<int>& labels) const {
+        if (labels.size() != inputs.rows()) {
+            throw std::invalid_argument("El número de etiquetas no coincide con el de entradas.");
+        }
+        if (inputs.cols() != weights.front().cols()) {
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        const size_t classes = weights.back().rows();
+
+        // Clasifica [first, last) en bloques y anota cada resultado en matrix
+        auto classify = [&](size_t first, size_t last, InferenceScratch<T>& scratch, ConfusionMatrix& matrix) {
+            int predicted[INFERENCE_BLOCK];
+            for (size_t start = first; start < last; start += INFERENCE_BLOCK) {
+                const size_t count = std::min(INFERENCE_BLOCK, last - start);
+                predict_batch(inputs[start].data(), count, predicted, scratch);
+                for (size_t k = 0; k < count; ++k) matrix.add(labels[start + k], predicted[k]);
             }
+        };
+
+        ConfusionMatrix result(classes);
+        if (pool) {
+            PerThread<InferenceScratch<T>> scratch(*pool, make_inference_scratch(INFERENCE_BLOCK));
+            PerThread<ConfusionMatrix> matrices(*pool, ConfusionMatrix(classes));
+            pool->parallel_for(0, inputs.rows(), INFERENCE_BLOCK, [&](size_t first, size_t last) {
+                classify(first, last, scratch.local(), matrices.local());
+            });
+            for (size_t t = 0; t < matrices.size(); ++t) result.merge(matrices[t]);
+        } else {
+            InferenceScratch<T> scratch = make_inference_scratch(INFERENCE_BLOCK);
+            classify(0, inputs.rows(), scratch, result);
         }
-        return static_cast<double>(correct) / inputs.size() * 100.0;
+        return result;
     }
 
     /**
-     * Predice la etiqueta de una entrada.
+     * Evalúa la red neuronal en un conjunto de prueba.
+     * Para precisión y exhaustividad por clase usar confusion_matrix.
+     * @param inputs Entradas de prueba (una fila por muestra; T o bytes).
+     * @param labels Etiquetas correspondientes.
+     * @return Precisión de la red en el conjunto de prueba.
+     * @throws std::invalid_argument si el tamaño de las entradas no es el de la primera capa.
+     */
+    template <typename Inputs>
+    double evaluate(const Inputs& inputs, const std::vector<int>& labels) const {
+        return confusion_matrix(inputs, labels).accuracy() * 100.0;
+    }
+
+    /**
+     * Predice la etiqueta de una entrada usando la memoria de trabajo de la red
+     * (y el SpinTeam, si hay uno). No es segura entre hilos; para inferencia
+     * concurrente usar predict con scratch propio.
      * @param input Entrada de la red.
      * @return Etiqueta predicha.
+     * @throws std::invalid_argument si el tamaño de la entrada no es el de la primera capa.
      */
-    int predict(const Vector<T>& input) {
-        Vector<T> output = forward_propagation(input);
-        return std::distance(output.begin(), std::max_element(output.begin(), output.end()));
+    int predict(std::span<const T> input) {
+        return argmax(forward_propagation(workspace, input, team));
     }
 };
 
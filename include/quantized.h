@@ -0,0 +1,323 @@
+#ifndef QUANTIZED_H
+#define QUANTIZED_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <span>
+#include <algorithm>
+#include <stdexcept>
+#include "common.h"
+#include "network.h"
+#include "metrics.h"
+
+/**
+ * Memoria de trabajo de la inferencia cuantizada: dos buffers de activaciones de
+ * 8 bits que las capas usan alternadamente, los acumuladores int32 de una capa y
+ * sus sumas parciales en float (camino del GEMM float), para batch muestras.
+ * Cada hilo que infiera necesita la suya.
+ */
+struct QuantizedScratch {
+    Matrix<uint8_t> front;
+    Matrix<uint8_t> back;
+    Matrix<int32_t> accumulators;
+    Matrix<float> partial;
+    size_t batch = 0;
+
+    QuantizedScratch() = default;
+
+    /**
+     * @param width Neuronas de la capa más ancha.
+     * @param batch Muestras que se propagan juntas.
+     */
+    QuantizedScratch(size_t width, size_t batch)
+        : front(batch, width), back(batch, width), accumulators(batch, width), partial(batch, width),
+          batch(batch) {}
+};
+
+/**
+ * Red de inferencia int8 obtenida por cuantización posterior al entrenamiento de
+ * una NeuralNetwork.
+ * - Pesos int8 simétricos con una escala por neurona (canal de salida).
+ * - Activaciones uint8 con escala calibrada sobre una muestra de entradas, o la
+ *   aprendida en el entrenamiento con cuantización simulada (QAT); tras ReLU son
+ *   no negativas, así que no necesitan punto cero.
+ * - La entrada de la primera capa son los píxeles en bruto (Dataset<uint8_t>).
+ * - Cada capa acumula en int32 con Kernels::gemm_u8s8 (VNNI o AVX2 según la CPU).
+ *   Donde ese kernel no supera al GEMM float (portable y AVX-512 sin VNNI), los
+ *   bloques de muestras usan el GEMM float con los mismos enteros, por tramos de k
+ *   en los que toda suma parcial es exacta: los acumuladores salen idénticos.
+ * - Entre capas, el acumulador se recuantiza en float: escala, sesgo, ReLU y
+ *   redondeo a uint8 en una pasada. La última capa deja logits float para el argmax.
+ */
+class QuantizedNetwork {
+private:
+    struct Layer {
+        Matrix<int8_t> weights;           // Una fila por neurona
+        std::vector<int8_t, AlignedAllocator<int8_t>> packed; // Pesos en el formato de Kernels::gemm_u8s8
+        Matrix<float> float_weights;      // Los mismos enteros en float, para el GEMM float
+        std::vector<float> scales;        // Escala del acumulador por neurona: entrada * peso
+        std::vector<float> biases;
+        float output_scale = 1.0f;        // Escala de la salida uint8 (capas ocultas)
+        std::vector<float> multipliers;   // scales / output_scale: del acumulador a la salida uint8
+        std::vector<float> offsets;       // biases / output_scale
+    };
+
+    std::vector<Layer> layers;
+    size_t input_size = 0;
+    size_t width = 0;                     // Neuronas de la capa más ancha
+    ThreadPool* pool = nullptr;
+
+    static constexpr size_t BLOCK = 64;   // Muestras por bloque en predict_batch
+    static constexpr size_t MAX_CLASSES = 256;
+
+    // Con menos muestras, empaquetar los pesos para el GEMM float cuesta más que el producto
+    static constexpr size_t FLOAT_GEMM_MIN_ROWS = 16;
+
+    // Tramo de k con sumas exactas en float: 512 * 255 * 127 < 2^24
+    static constexpr size_t EXACT_FLOAT_K = 512;
+
+    static int argmax(std::span<const float> output) {
+        return std::distance(output.begin(), std::max_element(output.begin(), output.end()));
+    }
+
+    /**
+     * Acumuladores int32 de una capa (acc = x * W^T) con el GEMM float: los bytes se
+     * convierten al empaquetar y cada tramo de EXACT_FLOAT_K valores de k se suma
+     * en float sin redondeo antes de pasar a int32.
+     */
+    static void gemm_exact_float(size_t count, const Layer& layer, const uint8_t* x, size_t ldx, int32_t* acc,
+                                 float* partial) {
+        const size_t in = layer.weights.cols(), neurons = layer.weights.rows();
+        for (size_t p = 0; p < in; p += EXACT_FLOAT_K) {
+            const size_t kc = std::min(EXACT_FLOAT_K, in - p);
+            gemm(false, true, count, neurons, kc, 1.0f, x + p, ldx, layer.float_weights.data() + p, in, 0.0f, partial,
+                 neurons);
+            for (size_t i = 0; i < count * neurons; ++i) {
+                acc[i] = (p == 0 ? 0 : acc[i]) + static_cast<int32_t>(partial[i]);
+            }
+        }
+    }
+
+    /**
+     * Propaga un bloque de count muestras y escribe la clase predicha de cada una.
+     */
+    void predict_block(const uint8_t* inputs, size_t count, int* out, QuantizedScratch& scratch) const {
+        const uint8_t* x = inputs;
+        size_t ldx = input_size;
+        uint8_t* y = scratch.front.data();
+        uint8_t* other = scratch.back.data();
+        int32_t* acc = scratch.accumulators.data();
+        const bool float_gemm = count >= FLOAT_GEMM_MIN_ROWS && !Kernels::fast_u8s8();
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const Layer& layer = layers[l];
+            const size_t in = layer.weights.cols(), neurons = layer.weights.rows();
+            if (float_gemm) {
+                gemm_exact_float(count, layer, x, ldx, acc, scratch.partial.data());
+            } else {
+                Kernels::gemm_u8s8(count, neurons, in, x, ldx, layer.packed.data(), acc, neurons);
+            }
+
+            if (l + 1 == layers.size()) {
+                // Logits en float solo para elegir la clase
+                float logits[MAX_CLASSES];
+                for (size_t k = 0; k < count; ++k) {
+                    for (size_t j = 0; j < neurons; ++j) {
+                        logits[j] = static_cast<float>(acc[k * neurons + j]) * layer.scales[j] + layer.biases[j];
+                    }
+                    out[k] = argmax({logits, neurons});
+                }
+                return;
+            }
+
+            // Recuantización: z = acc * escala + sesgo en la escala de salida, con ReLU y redondeo
+            for (size_t k = 0; k < count; ++k) {
+                Kernels::requantize(acc + k * neurons, layer.multipliers.data(), layer.offsets.data(),
+                                    y + k * neurons, neurons);
+            }
+            x = y;
+            ldx = neurons;
+            std::swap(y, other);
+        }
+    }
+
+    /**
+     * Construye las capas a partir de los parámetros float y de la escala uint8 de
+     * la salida de cada capa oculta. Cada fila de pesos se cuantiza con el mismo
+     * redondeo que la cuantización simulada del entrenamiento (QAT), de modo que
+     * una red entrenada así llega a exactamente los mismos pesos.
+     */
+    template <typename T, typename Storage>
+    void build(const NeuralNetwork<T, Storage>& network, const std::vector<T>& activation_scales, float input_scale) {
+        const auto& weights = network.get_weights();
+        const auto& biases = network.get_biases();
+        if (weights.back().rows() > MAX_CLASSES) {
+            throw std::invalid_argument("La red cuantizada admite como mucho 256 clases.");
+        }
+        input_size = weights.front().cols();
+        float scale_in = input_scale;
+        for (size_t l = 0; l < weights.size(); ++l) {
+            const Matrix<T>& w = weights[l];
+            Layer layer;
+            layer.weights = Matrix<int8_t>(w.rows(), w.cols());
+            for (size_t j = 0; j < w.rows(); ++j) {
+                // Escala simétrica por neurona: el peso de mayor magnitud va a ±127
+                const T peak = Kernels::abs_max(w[j].data(), w.cols());
+                const T scale = peak > 0 ? peak / static_cast<T>(127) : static_cast<T>(1);
+                const T inv_scale = static_cast<T>(1) / scale;
+                for (size_t i = 0; i < w.cols(); ++i) {
+                    layer.weights(j, i) = static_cast<int8_t>(std::nearbyint(w(j, i) * inv_scale));
+                }
+                layer.scales.push_back(scale_in * static_cast<float>(scale));
+                layer.biases.push_back(static_cast<float>(biases[l][j]));
+            }
+            layer.float_weights = Matrix<float>(w.rows(), w.cols());
+            std::copy_n(layer.weights.data(), layer.weights.size(), layer.float_weights.data());
+            layer.packed.resize(Kernels::packed_u8s8_size(w.rows(), w.cols()));
+            Kernels::pack_u8s8(w.rows(), w.cols(), layer.weights.data(), w.cols(), layer.packed.data());
+            if (l + 1 < weights.size()) {
+                layer.output_scale = static_cast<float>(activation_scales[l]);
+                for (size_t j = 0; j < w.rows(); ++j) {
+                    layer.multipliers.push_back(layer.scales[j] / layer.output_scale);
+                    layer.offsets.push_back(layer.biases[j] / layer.output_scale);
+                }
+                scale_in = layer.output_scale;
+            }
+            width = std::max(width, w.rows());
+            layers.push_back(std::move(layer));
+        }
+    }
+
+public:
+    /**
+     * Cuantiza una red entrenada en coma flotante (cuantización posterior al
+     * entrenamiento): la escala de cada capa oculta sale de la mayor activación
+     * observada en las entradas de calibración.
+     * @param network Red float entrenada.
+     * @param calibration Entradas (normalizadas como en el entrenamiento, o bytes) con
+     *                    las que se miden los rangos de las activaciones.
+     * @param calibration_samples Muestras de calibración, repartidas por todo el conjunto.
+     * @param input_scale Valor real de una unidad de la entrada uint8 (1/255 para los
+     *                    píxeles que Dataset normaliza dividiendo por 255).
+     */
+    template <typename T, typename Storage, typename Inputs>
+    QuantizedNetwork(const NeuralNetwork<T, Storage>& network, const Inputs& calibration,
+                     size_t calibration_samples = 1024, float input_scale = 1.0f / 255.0f) {
+        std::vector<T> scales = network.activation_ranges(calibration, calibration_samples);
+        for (T& scale : scales) scale = scale > 0 ? scale / static_cast<T>(255) : static_cast<T>(1);
+        build(network, scales, input_scale);
+    }
+
+    /**
+     * Convierte una red entrenada con cuantización simulada
+     * (NeuralNetwork::enable_quantization_aware) usando las escalas que aprendió,
+     * sin calibración: el motor int8 reproduce la red tal como se entrenó.
+     * @param network Red entrenada en QAT.
+     * @param input_scale Valor real de una unidad de la entrada uint8.
+     */
+    template <typename T, typename Storage>
+    explicit QuantizedNetwork(const NeuralNetwork<T, Storage>& network, float input_scale = 1.0f / 255.0f) {
+        if (!network.get_quantization_aware()) {
+            throw std::invalid_argument("La red no se ha entrenado con cuantización simulada; falta calibración.");
+        }
+        build(network, network.get_activation_scales(), input_scale);
+    }
+
+    /**
+     * Usa un pool de hilos en confusion_matrix y evaluate (no se toma su propiedad).
+     */
+    void set_thread_pool(ThreadPool* thread_pool) { pool = thread_pool; }
+
+    /**
+     * Crea memoria de trabajo para predict y predict_batch.
+     * @param batch Muestras por bloque en predict_batch.
+     */
+    QuantizedScratch make_scratch(size_t batch = BLOCK) const { return QuantizedScratch(width, batch); }
+
+    /**
+     * Predice las etiquetas de n entradas uint8 contiguas, en bloques de scratch.batch muestras.
+     * Varios hilos pueden llamarla a la vez, cada uno con su scratch.
+     * @param inputs Primera fila del bloque (n filas de bytes del tamaño de la entrada).
+     * @param n Número de muestras.
+     * @param out Etiqueta predicha de cada muestra (n elementos).
+     * @param scratch Memoria de trabajo del llamador (ver make_scratch).
+     */
+    void predict_batch(const uint8_t* inputs, size_t n, int* out, QuantizedScratch& scratch) const {
+        if (scratch.batch == 0 || scratch.front.cols() < width) {
+            throw std::invalid_argument("La memoria de inferencia es demasiado pequeña para esta red.");
+        }
+        for (size_t start = 0; start < n; start += scratch.batch) {
+            const size_t count = std::min(scratch.batch, n - start);
+            predict_block(inputs + start * input_size, count, out + start, scratch);
+        }
+    }
+
+    void predict_batch(const uint8_t* inputs, size_t n, int* out) const {
+        QuantizedScratch scratch = make_scratch(std::max<size_t>(1, std::min(n, BLOCK)));
+        predict_batch(inputs, n, out, scratch);
+    }
+
+    /**
+     * Predice la etiqueta de una entrada.
+     * @param input Bytes de la entrada.
+     * @param scratch Memoria de trabajo del llamador.
+     */
+    int predict(std::span<const uint8_t> input, QuantizedScratch& scratch) const {
+        if (input.size() != input_size) {
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        int label = 0;
+        predict_batch(input.data(), 1, &label, scratch);
+        return label;
+    }
+
+    /**
+     * Clasifica un conjunto de prueba en bytes y acumula la matriz de confusión
+     * (con pool, una matriz por hilo que se combinan al final).
+     * @param inputs Entradas uint8 (una fila por muestra): Matrix<uint8_t> o MatrixView<uint8_t>.
+     * @param labels Etiquetas correspondientes.
+     */
+    template <typename Inputs>
+    ConfusionMatrix confusion_matrix(const Inputs& inputs, const std::vector<int>& labels) const {
+        if (labels.size() != inputs.rows()) {
+            throw std::invalid_argument("El número de etiquetas no coincide con el de entradas.");
+        }
+        if (inputs.cols() != input_size) {
+            throw std::invalid_argument("El tamaño de la entrada no coincide con la primera capa.");
+        }
+        const size_t classes = layers.back().weights.rows();
+
+        auto classify = [&](size_t first, size_t last, QuantizedScratch& scratch, ConfusionMatrix& matrix) {
+            int predicted[BLOCK];
+            for (size_t start = first; start < last; start += BLOCK) {
+                const size_t count = std::min(BLOCK, last - start);
+                predict_batch(inputs[start].data(), count, predicted, scratch);
+                for (size_t k = 0; k < count; ++k) matrix.add(labels[start + k], predicted[k]);
+            }
+        };
+
+        ConfusionMatrix result(classes);
+        if (pool) {
+            PerThread<QuantizedScratch> scratch(*pool, make_scratch());
+            PerThread<ConfusionMatrix> matrices(*pool, ConfusionMatrix(classes));
+            pool->parallel_for(0, inputs.rows(), BLOCK, [&](size_t first, size_t last) {
+                classify(first, last, scratch.local(), matrices.local());
+            });
+            for (size_t t = 0; t < matrices.size(); ++t) result.merge(matrices[t]);
+        } else {
+            QuantizedScratch scratch = make_scratch();
+            classify(0, inputs.rows(), scratch, result);
+        }
+        return result;
+    }
+
+    /**
+     * Precisión (en %) sobre un conjunto de prueba en bytes.
+     */
+    template <typename Inputs>
+    double evaluate(const Inputs& inputs, const std::vector<int>& labels) const {
+        return confusion_matrix(inputs, labels).accuracy() * 100.0;
+    }
+};
+
+#endif // QUANTIZED_H
@@ -0,0 +1,229 @@
+#ifndef STREAMING_DATASET_H
+#define STREAMING_DATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "tensor.h"
+#include "idx_file.h"     // Validación de la cabecera
+#include "chunk_reader.h" // Lecturas asíncronas (io_uring o hilos con pread)
+
+/**
+ * Conjunto de entrenamiento IDX leído desde disco por bloques, para conjuntos que
+ * no caben en memoria (EMNIST o mayores). Las imágenes se dividen en bloques de
+ * tamaño fijo que se leen de forma asíncrona con ChunkReader: mientras la red
+ * entrena con un bloque, el kernel ya está leyendo los siguientes.
+ * La memoria está acotada: read_ahead() buffers de lectura más un bloque barajado
+ * caben en el presupuesto indicado, sea cual sea el tamaño del archivo (solo se
+ * suma el resto de un lote, menos de batch_size filas, que pasa al bloque siguiente).
+ * Cada época recorre los bloques en un orden aleatorio y baraja las muestras
+ * dentro de cada bloque, así que los lotes se mezclan sin accesos aleatorios
+ * por muestra al disco. NeuralNetwork::train acepta el conjunto directamente.
+ */
+class StreamingDataset {
+public:
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = std::size_t{64} << 20;
+    static constexpr std::size_t DEFAULT_CHUNK_BYTES = std::size_t{4} << 20;
+
+    /**
+     * Valida las cabeceras y reserva los buffers; no lee ninguna imagen todavía.
+     * @param image_path Archivo IDX de imágenes (la primera dimensión son las muestras).
+     * @param label_path Archivo IDX de etiquetas (una dimensión).
+     * @param memory_budget Bytes para buffers de lectura y el bloque barajado.
+     * @param chunk_bytes Bytes por bloque leído (se redondea a imágenes completas).
+     * @param backend Mecanismo de lectura asíncrona (ver ReadBackend).
+     * @throws std::invalid_argument si el presupuesto no da para dos bloques.
+     * @throws std::runtime_error si los archivos no son válidos o no coinciden.
+     */
+    StreamingDataset(const std::string& image_path, const std::string& label_path,
+                     std::size_t memory_budget = DEFAULT_MEMORY_BUDGET,
+                     std::size_t chunk_bytes = DEFAULT_CHUNK_BYTES,
+                     ReadBackend backend = ReadBackend::Auto)
+        : image_header(read_header(image_path)), label_header(read_header(label_path)),
+          rng(std::random_device{}()) {
+        if (image_header.dims.size() < 2) {
+            throw std::runtime_error("Error: el archivo de imágenes tiene dimensiones inválidas.");
+        }
+        if (label_header.dims.size() != 1) {
+            throw std::runtime_error("Error: el archivo de etiquetas no tiene un encabezado válido.");
+        }
+        if (image_header.type != IdxType::UInt8 || label_header.type != IdxType::UInt8) {
+            throw std::runtime_error("Error: StreamingDataset solo lee imágenes y etiquetas en bytes sin signo.");
+        }
+        samples = image_header.dims[0];
+        row_bytes = image_header.elements / samples;
+        if (label_header.elements != samples) {
+            throw std::runtime_error("Error: el número de imágenes no coincide con el de etiquetas.");
+        }
+
+        // Un bloque de lectura ocupa sus píxeles y sus etiquetas en bytes; el bloque
+        // barajado, los píxeles y las etiquetas como enteros (ninguno pasa de chunk_bytes)
+        rows_per_chunk = std::min(samples, std::max<std::size_t>(chunk_bytes / (row_bytes + sizeof(int)), 1));
+        chunk_count = (samples + rows_per_chunk - 1) / rows_per_chunk;
+        const std::size_t slot_bytes = rows_per_chunk * (row_bytes + 1);
+        const std::size_t staged_bytes = rows_per_chunk * (row_bytes + sizeof(int));
+        if (memory_budget < slot_bytes + staged_bytes) {
+            throw std::invalid_argument("El presupuesto de memoria no da para leer un bloque y barajarlo.");
+        }
+        const std::size_t depth = std::min((memory_budget - staged_bytes) / slot_bytes, chunk_count);
+
+        slots.resize(depth);
+        for (auto& slot : slots) {
+            slot.pixels.resize(rows_per_chunk * row_bytes);
+            slot.labels.resize(rows_per_chunk);
+        }
+        image_reader = std::make_unique<ChunkReader>(image_path, depth, backend);
+        label_reader = std::make_unique<ChunkReader>(label_path, depth, backend);
+    }
+
+    // Número de muestras y bytes por imagen
+    std::size_t size() const { return samples; }
+    std::size_t cols() const { return row_bytes; }
+
+    // Muestras por bloque, número de bloques y bloques que se leen por adelantado
+    std::size_t chunk_rows() const { return rows_per_chunk; }
+    std::size_t chunks() const { return chunk_count; }
+    std::size_t read_ahead() const { return slots.size(); }
+
+    // Bytes reservados en buffers (lectura y bloque barajado)
+    std::size_t memory_bytes() const {
+        return slots.size() * rows_per_chunk * (row_bytes + 1) + staged_pixels.capacity() +
+               staged_labels.capacity() * sizeof(int) + batch_labels.capacity() * sizeof(int);
+    }
+
+    // true si las lecturas van por io_uring
+    bool uses_io_uring() const { return image_reader->uses_io_uring(); }
+
+    // Fija la semilla del barajado (por defecto es aleatoria)
+    void set_seed(std::uint32_t seed) { rng.seed(seed); }
+
+    /**
+     * Recorre una época: lee los bloques en orden aleatorio, baraja cada uno y
+     * entrega sus muestras en tandas de un número entero de lotes (el resto de un
+     * lote se une al bloque siguiente; la última tanda puede quedar incompleta).
+     * @param batch_size Tamaño de lote con el que se va a entrenar.
+     * @param f Función f(MatrixView<uint8_t> imágenes, const std::vector<int>& etiquetas),
+     *          válidos solo durante la llamada.
+     */
+    template <typename Function>
+    void for_each_chunk(std::size_t batch_size, const Function& f) {
+        if (batch_size == 0) {
+            throw std::invalid_argument("El tamaño de lote debe ser mayor que cero.");
+        }
+        staged_pixels.resize((rows_per_chunk + batch_size - 1) * row_bytes);
+        staged_labels.resize(rows_per_chunk + batch_size - 1);
+
+        std::vector<std::size_t> order(chunk_count);
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::shuffle(order.begin(), order.end(), rng);
+
+        const std::size_t depth = slots.size();
+        std::size_t submitted = 0;
+        try {
+            for (; submitted < depth; ++submitted) submit(submitted % depth, order[submitted]);
+
+            std::size_t held = 0; // Filas barajadas pendientes de entregar
+            for (std::size_t k = 0; k < chunk_count; ++k) {
+                Slot& slot = slots[k % depth];
+                image_reader->wait(k % depth);
+                label_reader->wait(k % depth);
+
+                // Barajado dentro del bloque al copiarlo tras el resto del anterior
+                row_order.resize(slot.rows);
+                std::iota(row_order.begin(), row_order.end(), std::size_t{0});
+                std::shuffle(row_order.begin(), row_order.end(), rng);
+                for (std::size_t i = 0; i < slot.rows; ++i) {
+                    std::memcpy(&staged_pixels[(held + i) * row_bytes], &slot.pixels[row_order[i] * row_bytes],
+                                row_bytes);
+                    staged_labels[held + i] = slot.labels[row_order[i]];
+                }
+                held += slot.rows;
+
+                // El buffer ya está copiado: se reutiliza para leer otro bloque mientras se entrena
+                if (submitted < chunk_count) {
+                    submit(k % depth, order[submitted]);
+                    ++submitted;
+                }
+
+                const std::size_t ready = k + 1 == chunk_count ? held : held - held % batch_size;
+                if (ready == 0) continue;
+                batch_labels.assign(staged_labels.begin(), staged_labels.begin() + ready);
+                f(MatrixView<std::uint8_t>(staged_pixels.data(), ready, row_bytes), batch_labels);
+
+                held -= ready;
+                std::memmove(staged_pixels.data(), &staged_pixels[ready * row_bytes], held * row_bytes);
+                std::copy(staged_labels.begin() + ready, staged_labels.begin() + ready + held, staged_labels.begin());
+            }
+        } catch (...) {
+            drain(submitted);
+            throw;
+        }
+    }
+
+private:
+    // Buffer de lectura de un bloque
+    struct Slot {
+        std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>> pixels;
+        std::vector<std::uint8_t> labels;
+        std::size_t rows = 0;
+    };
+
+    IdxHeader image_header;
+    IdxHeader label_header;
+    std::size_t samples = 0;
+    std::size_t row_bytes = 0;
+    std::size_t rows_per_chunk = 0;
+    std::size_t chunk_count = 0;
+    std::mt19937 rng;
+
+    std::vector<Slot> slots;
+    std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>> staged_pixels; // Bloque barajado
+    std::vector<int> staged_labels;
+    std::vector<int> batch_labels; // Etiquetas de la tanda entregada
+    std::vector<std::size_t> row_order;
+
+    // Declarados tras los buffers para destruirse antes: esperan a las lecturas en vuelo
+    std::unique_ptr<ChunkReader> image_reader;
+    std::unique_ptr<ChunkReader> label_reader;
+
+    // Cabecera de un archivo sin comprimir (los bloques se leen en orden aleatorio)
+    static IdxHeader read_header(const std::string& path) {
+        if (GzipReader::is_gzip(path)) {
+            throw std::runtime_error("Error: StreamingDataset necesita el archivo " + path + " sin comprimir.");
+        }
+        return IdxHeader::read(path);
+    }
+
+    // Encola la lectura de un bloque en un buffer
+    void submit(std::size_t slot_index, std::size_t chunk) {
+        Slot& slot = slots[slot_index];
+        const std::size_t first = chunk * rows_per_chunk;
+        slot.rows = std::min(rows_per_chunk, samples - first);
+        image_reader->submit(image_header.offset + first * row_bytes,
+                             std::span<std::uint8_t>(slot.pixels.data(), slot.rows * row_bytes), slot_index);
+        label_reader->submit(label_header.offset + first, std::span<std::uint8_t>(slot.labels.data(), slot.rows),
+                             slot_index);
+    }
+
+    // Tras un error, espera a las lecturas aún en vuelo para dejar los lectores listos
+    void drain(std::size_t submitted) noexcept {
+        for (std::size_t tag = 0; tag < std::min(submitted, slots.size()); ++tag) {
+            for (ChunkReader* reader : {image_reader.get(), label_reader.get()}) {
+                try {
+                    reader->wait(tag);
+                } catch (...) {
+                }
+            }
+        }
+    }
+};
+
+#endif // STREAMING_DATASET_H
@@ -0,0 +1,213 @@
+#ifndef TENSOR_H
+#define TENSOR_H
+
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <new>         // Para std::align_val_t
+#include <numeric>     // Para std::accumulate
+#include <algorithm>   // Para std::fill
+#include <functional>  // Para std::multiplies
+#include <stdexcept>
+#include <initializer_list>
+
+// Alineación de los buffers: una línea de caché (y un registro AVX-512)
+constexpr std::size_t TENSOR_ALIGNMENT = 64;
+
+/**
+ * Asignador que entrega memoria alineada a TENSOR_ALIGNMENT bytes.
+ * Garantiza que cada buffer ocupe líneas de caché propias (sin false sharing
+ * entre buffers de distintos hilos).
+ * @tparam T Tipo de dato.
+ */
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    // El tamaño se redondea a líneas completas: dos buffers nunca comparten línea
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(padded_bytes(n), std::align_val_t(TENSOR_ALIGNMENT)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ::operator delete(p, padded_bytes(n), std::align_val_t(TENSOR_ALIGNMENT));
+    }
+
+    static std::size_t padded_bytes(std::size_t n) {
+        return (n * sizeof(T) + TENSOR_ALIGNMENT - 1) / TENSOR_ALIGNMENT * TENSOR_ALIGNMENT;
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+};
+
+/**
+ * Tensor denso en orden row-major almacenado en un único buffer contiguo.
+ * Para el caso de dos dimensiones, operator[] devuelve la fila como un span,
+ * de modo que mat[i][j] sigue funcionando sin asignaciones por fila.
+ * @tparam T Tipo de dato.
+ */
+template <typename T>
+class Tensor {
+private:
+    std::vector<std::size_t> dims;                // Tamaño de cada dimensión
+    std::vector<std::size_t> steps;               // Strides en elementos
+    std::vector<T, AlignedAllocator<T>> buffer;   // Datos contiguos
+
+    // Recalcula los strides row-major a partir de la forma
+    void compute_strides() {
+        steps.assign(dims.size(), 1);
+        for (std::size_t i = dims.size(); i-- > 1;) {
+            steps[i - 1] = steps[i] * dims[i];
+        }
+    }
+
+    static std::size_t element_count(const std::vector<std::size_t>& shape) {
+        return std::accumulate(shape.begin(), shape.end(), std::size_t{1}, std::multiplies<>());
+    }
+
+public:
+    Tensor() = default;
+
+    /**
+     * Crea un tensor con la forma indicada.
+     * @param shape Tamaño de cada dimensión.
+     * @param value Valor inicial de todos los elementos.
+     */
+    explicit Tensor(std::vector<std::size_t> shape, T value = T{})
+            : dims(std::move(shape)), buffer(element_count(dims), value) {
+        compute_strides();
+    }
+
+    /**
+     * Crea una matriz (tensor de dos dimensiones).
+     * @param rows Número de filas.
+     * @param cols Número de columnas.
+     * @param value Valor inicial de todos los elementos.
+     */
+    Tensor(std::size_t rows, std::size_t cols, T value = T{})
+            : Tensor(std::vector<std::size_t>{rows, cols}, value) {}
+
+    // Información de forma
+    std::size_t rank() const { return dims.size(); }
+    const std::vector<std::size_t>& shape() const { return dims; }
+    const std::vector<std::size_t>& strides() const { return steps; }
+    std::size_t dim(std::size_t axis) const { return dims.at(axis); }
+    std::size_t size() const { return buffer.size(); }
+    bool empty() const { return buffer.empty(); }
+
+    // Vista como matriz: la primera dimensión son las filas y el resto se aplana en columnas
+    std::size_t rows() const { return dims.empty() ? 0 : dims[0]; }
+    std::size_t cols() const { return dims.empty() ? 0 : steps[0]; }
+
+    // Acceso al buffer
+    T* data() { return buffer.data(); }
+    const T* data() const { return buffer.data(); }
+    T* begin() { return buffer.data(); }
+    T* end() { return buffer.data() + buffer.size(); }
+    const T* begin() const { return buffer.data(); }
+    const T* end() const { return buffer.data() + buffer.size(); }
+
+    /**
+     * Devuelve la fila i (todos los elementos con el primer índice igual a i).
+     * @param i Índice de la fila.
+     * @return Span sobre la fila, sin copia.
+     */
+    std::span<T> row(std::size_t i) { return {buffer.data() + i * cols(), cols()}; }
+    std::span<const T> row(std::size_t i) const { return {buffer.data() + i * cols(), cols()}; }
+
+    std::span<T> operator[](std::size_t i) { return row(i); }
+    std::span<const T> operator[](std::size_t i) const { return row(i); }
+
+    // Acceso a un elemento de una matriz
+    T& operator()(std::size_t i, std::size_t j) { return buffer[i * steps[0] + j]; }
+    const T& operator()(std::size_t i, std::size_t j) const { return buffer[i * steps[0] + j]; }
+
+    /**
+     * Acceso a un elemento con índices de cualquier rango.
+     * @param index Un índice por dimensión.
+     * @return Referencia al elemento.
+     */
+    T& at(std::initializer_list<std::size_t> index) {
+        return buffer[offset(index)];
+    }
+    const T& at(std::initializer_list<std::size_t> index) const {
+        return buffer[offset(index)];
+    }
+
+    std::size_t offset(std::initializer_list<std::size_t> index) const {
+        if (index.size() != dims.size()) {
+            throw std::invalid_argument("El número de índices no coincide con el rango del tensor.");
+        }
+        std::size_t off = 0, axis = 0;
+        for (std::size_t i : index) {
+            if (i >= dims[axis]) {
+                throw std::out_of_range("Índice fuera de rango en el tensor.");
+            }
+            off += i * steps[axis++];
+        }
+        return off;
+    }
+
+    /**
+     * Cambia la forma del tensor sin mover los datos.
+     * @param shape Nueva forma; debe tener el mismo número de elementos.
+     */
+    void reshape(std::vector<std::size_t> shape) {
+        if (element_count(shape) != buffer.size()) {
+            throw std::invalid_argument("La nueva forma no conserva el número de elementos.");
+        }
+        dims = std::move(shape);
+        compute_strides();
+    }
+
+    // Asigna el mismo valor a todos los elementos
+    void fill(T value) { std::fill(buffer.begin(), buffer.end(), value); }
+};
+
+/**
+ * Vista de solo lectura de una matriz row-major contigua que no es dueña de sus
+ * datos (por ejemplo, las imágenes de un archivo mapeado en memoria). Ofrece la
+ * misma interfaz de lectura que una matriz Tensor (rows, cols, size, data y
+ * operator[]), así que sirve donde se recorren las filas de una entrada.
+ * @tparam T Tipo de dato.
+ */
+template <typename T>
+class MatrixView {
+private:
+    const T* values = nullptr;
+    std::size_t n_rows = 0;
+    std::size_t n_cols = 0;
+
+public:
+    MatrixView() = default;
+
+    /**
+     * @param data Primer elemento (rows * cols elementos contiguos).
+     * @param rows Número de filas.
+     * @param cols Número de columnas.
+     */
+    MatrixView(const T* data, std::size_t rows, std::size_t cols) : values(data), n_rows(rows), n_cols(cols) {}
+
+    // Vista sobre una matriz existente (que debe vivir más que la vista)
+    MatrixView(const Tensor<T>& matrix) : values(matrix.data()), n_rows(matrix.rows()), n_cols(matrix.cols()) {}
+
+    std::size_t rows() const { return n_rows; }
+    std::size_t cols() const { return n_cols; }
+    std::size_t size() const { return n_rows * n_cols; }
+    bool empty() const { return size() == 0; }
+
+    const T* data() const { return values; }
+    const T* begin() const { return values; }
+    const T* end() const { return values + size(); }
+
+    std::span<const T> row(std::size_t i) const { return {values + i * n_cols, n_cols}; }
+    std::span<const T> operator[](std::size_t i) const { return row(i); }
+    const T& operator()(std::size_t i, std::size_t j) const { return values[i * n_cols + j]; }
+};
+
+#endif // TENSOR_H
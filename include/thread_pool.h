@@ -0,0 +1,320 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+#include "tensor.h" // Para TENSOR_ALIGNMENT
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h> // Para _mm_pause
+#endif
+
+/**
+ * Pool de hilos con robo de trabajo (work stealing).
+ * Cada hilo tiene su propia cola doble: el dueño apila y desapila por el final
+ * (LIFO, datos aún calientes en caché) y los demás roban por el principio (FIFO,
+ * las tareas más grandes de una división recursiva). El hilo que crea el pool
+ * también ejecuta tareas mientras espera, así que un pool de N hilos arranca
+ * N - 1 trabajadores; los hilos externos comparten la última cola, pero cada uno
+ * tiene su propia posición (ver slot()).
+ */
+class ThreadPool {
+public:
+    /**
+     * Arranca el pool.
+     * @param threads Hilos que ejecutan tareas, contando el que espera (mínimo 1).
+     * @param pin Si es true, fija cada trabajador a un núcleo (el 0 queda para el hilo principal).
+     */
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency(), bool pin = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Hilos que pueden ejecutar tareas a la vez (trabajadores más el hilo que espera)
+    std::size_t size() const { return queues.size(); }
+
+    /**
+     * Posición del hilo actual en el pool: [0, size() - 1) para los trabajadores y
+     * desde size() - 1 en adelante para los hilos externos, cada uno con la suya
+     * (densas: la de un hilo que termina pasa al siguiente que la pida). Así varios
+     * hilos externos pueden esperar a la vez sin compartir memoria de PerThread.
+     */
+    std::size_t slot() const;
+
+    /**
+     * Encola una tarea en la cola del hilo actual.
+     * @param task Tarea a ejecutar; no debe lanzar excepciones (TaskGroup las captura).
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Ejecuta una tarea pendiente (propia o robada), si la hay.
+     * @return true si se ejecutó alguna tarea.
+     */
+    bool run_one();
+
+    /**
+     * Ejecuta f(inicio, fin) sobre subrangos de [begin, end) de como mucho grain
+     * elementos, repartidos entre los hilos del pool. Vuelve cuando todos terminan.
+     * @param begin Inicio del rango.
+     * @param end Fin del rango (exclusivo).
+     * @param grain Tamaño máximo de cada subrango (mínimo 1).
+     * @param f Función que recibe los límites de un subrango.
+     */
+    template <typename Function>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const Function& f);
+
+private:
+    struct alignas(TENSOR_ALIGNMENT) Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // Una por trabajador, más una compartida por los hilos externos
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> pending{0};         // Tareas encoladas aún no tomadas
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    bool take_task(std::size_t index, std::function<void()>& task);
+    void worker_loop(std::size_t index, bool pin);
+};
+
+/**
+ * Grupo de tareas con semántica fork/join: run lanza una tarea y wait espera a
+ * todas, ejecutando tareas pendientes mientras tanto (también es seguro dentro
+ * de una tarea del pool). La primera excepción lanzada se relanza en wait.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { join(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Function>
+    void run(Function f) {
+        outstanding.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([this, f = std::move(f)]() mutable {
+            try {
+                f();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+            }
+            outstanding.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void wait() {
+        join();
+        if (error) std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+private:
+    ThreadPool& pool;
+    std::atomic<std::size_t> outstanding{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    void join() {
+        while (outstanding.load(std::memory_order_acquire) > 0) {
+            if (!pool.run_one()) std::this_thread::yield();
+        }
+    }
+};
+
+/**
+ * Memoria auxiliar por hilo del pool: un valor por posición, cada uno en líneas
+ * de caché propias. local() devuelve el del hilo actual; los trabajadores y el
+ * primer hilo externo lo leen sin sincronización, y las posiciones de otros hilos
+ * externos se crean la primera vez que las piden (bajo un mutex).
+ * @tparam T Tipo del valor.
+ */
+template <typename T>
+class PerThread {
+public:
+    /**
+     * @param pool Pool cuyos hilos usarán los valores.
+     * @param init Valor inicial de cada posición.
+     */
+    explicit PerThread(const ThreadPool& pool, const T& init = T{}) : pool(pool), init(init) {
+        slots.reserve(pool.size());
+        for (std::size_t i = 0; i < pool.size(); ++i) slots.push_back(Slot{init});
+    }
+
+    T& local() {
+        const std::size_t i = pool.slot();
+        if (i < slots.size()) return slots[i].value;
+        // deque no mueve los elementos al crecer: las referencias ya entregadas siguen válidas
+        std::lock_guard<std::mutex> lock(extra_mutex);
+        while (slots.size() + extra.size() <= i) extra.push_back(Slot{init});
+        return extra[i - slots.size()].value;
+    }
+
+    // Posiciones creadas; recorrerlas solo cuando ningún hilo esté usando local()
+    std::size_t size() const { return slots.size() + extra.size(); }
+    T& operator[](std::size_t i) { return i < slots.size() ? slots[i].value : extra[i - slots.size()].value; }
+    const T& operator[](std::size_t i) const {
+        return i < slots.size() ? slots[i].value : extra[i - slots.size()].value;
+    }
+
+private:
+    struct alignas(TENSOR_ALIGNMENT) Slot { T value; };
+
+    const ThreadPool& pool;
+    const T init;
+    std::vector<Slot> slots;  // Trabajadores y primer hilo externo
+    std::deque<Slot> extra;   // Resto de hilos externos
+    std::mutex extra_mutex;
+};
+
+namespace detail {
+    // División recursiva: se lanza la mitad derecha y se sigue con la izquierda
+    template <typename Function>
+    void split_range(TaskGroup& group, std::size_t begin, std::size_t end, std::size_t grain,
+                     const Function& f) {
+        while (end - begin > grain) {
+            const std::size_t mid = begin + (end - begin) / 2;
+            group.run([&group, mid, end, grain, &f] { split_range(group, mid, end, grain, f); });
+            end = mid;
+        }
+        f(begin, end);
+    }
+}
+
+template <typename Function>
+void ThreadPool::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const Function& f) {
+    if (begin >= end) return;
+    grain = std::max<std::size_t>(grain, 1);
+    if (size() == 1 || end - begin <= grain) {
+        f(begin, end);
+        return;
+    }
+    TaskGroup group(*this);
+    detail::split_range(group, begin, end, grain, f);
+    group.wait();
+}
+
+// Pausa breve dentro de una espera activa (libera recursos del núcleo hermano con SMT)
+inline void spin_pause() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Iteraciones de espera activa antes de empezar a ceder el procesador
+constexpr unsigned SPIN_LIMIT = 4096;
+
+/**
+ * Barrera de espera activa para un número fijo de hilos. A diferencia de
+ * std::barrier nunca duerme al hilo, así que cruzarla cuesta del orden de una
+ * transferencia de línea de caché; tras SPIN_LIMIT intentos cede el procesador.
+ */
+class SpinBarrier {
+public:
+    explicit SpinBarrier(std::size_t parties) : parties(parties) {}
+
+    void arrive_and_wait() {
+        const std::size_t current = generation.load(std::memory_order_acquire);
+        if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == parties) {
+            arrived.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        for (unsigned spins = 0; generation.load(std::memory_order_acquire) == current; ++spins) {
+            if (spins < SPIN_LIMIT) spin_pause(); else std::this_thread::yield();
+        }
+    }
+
+private:
+    const std::size_t parties;
+    alignas(TENSOR_ALIGNMENT) std::atomic<std::size_t> arrived{0};
+    alignas(TENSOR_ALIGNMENT) std::atomic<std::size_t> generation{0};
+};
+
+/**
+ * Equipo fijo de hilos en espera activa para paralelismo dentro de una operación
+ * pequeña (por ejemplo, una inferencia de una sola muestra), donde despertar hilos
+ * de un pool costaría más que el propio cálculo. run(f) ejecuta f(índice) en todos
+ * los hilos del equipo (el que llama es el 0) y sync() los sincroniza entre fases.
+ * Mientras el equipo existe sus hilos ocupan sus núcleos; solo un hilo puede
+ * llamar a run a la vez.
+ */
+class SpinTeam {
+public:
+    /**
+     * @param threads Hilos del equipo, contando el que llama a run (mínimo 1).
+     * @param pin Si es true, fija cada hilo auxiliar a un núcleo (el 0 queda para el que llama).
+     */
+    explicit SpinTeam(std::size_t threads, bool pin = false);
+    ~SpinTeam();
+
+    SpinTeam(const SpinTeam&) = delete;
+    SpinTeam& operator=(const SpinTeam&) = delete;
+
+    std::size_t size() const { return helpers.size() + 1; }
+
+    /**
+     * Ejecuta f(índice) en cada hilo del equipo y vuelve cuando todos terminan.
+     * @param f Función que recibe el índice del hilo en [0, size()); no debe lanzar excepciones.
+     */
+    template <typename Function>
+    void run(const Function& f) {
+        if (helpers.empty()) {
+            f(std::size_t{0});
+            return;
+        }
+        job = [](const void* context, std::size_t index) { (*static_cast<const Function*>(context))(index); };
+        job_context = &f;
+        finished.store(0, std::memory_order_relaxed);
+        epoch.fetch_add(1, std::memory_order_release);
+        f(std::size_t{0});
+        for (unsigned spins = 0; finished.load(std::memory_order_acquire) < helpers.size(); ++spins) {
+            if (spins < SPIN_LIMIT) spin_pause(); else std::this_thread::yield();
+        }
+    }
+
+    // Barrera entre fases de una misma llamada a run (la cruzan todos los hilos del equipo)
+    void sync() { barrier.arrive_and_wait(); }
+
+private:
+    SpinBarrier barrier;
+    std::vector<std::thread> helpers;
+    void (*job)(const void*, std::size_t) = nullptr;
+    const void* job_context = nullptr;
+    alignas(TENSOR_ALIGNMENT) std::atomic<std::size_t> epoch{0};    // Se incrementa con cada run
+    alignas(TENSOR_ALIGNMENT) std::atomic<std::size_t> finished{0}; // Auxiliares que acabaron el run actual
+    std::atomic<bool> stopping{false};
+
+    void helper_loop(std::size_t index, bool pin);
+};
+
+/**
+ * parallel_for con pool opcional: sin pool se ejecuta todo el rango en el hilo actual.
+ */
+template <typename Function>
+void parallel_for(ThreadPool* pool, std::size_t begin, std::size_t end, std::size_t grain, const Function& f) {
+    if (pool) {
+        pool->parallel_for(begin, end, grain, f);
+    } else if (begin < end) {
+        f(begin, end);
+    }
+}
+
+#endif // THREAD_POOL_H
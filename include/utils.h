@@ -4,6 +4,9 @@
 #include <vector>
 #include <iostream>
 #include <iomanip> // Para formatear la salida
+#include <span>
+#include <type_traits>
+#include "tensor.h"
 
 /**
  * Muestra una matriz en la consola (usada para depuración o visualización).
@@ -21,30 +24,52 @@ void display_matrix(const std::vector<std::vector<T>>& matrix) {
     std::cout << std::endl;
 }
 
+/**
+ * Muestra una matriz contigua en la consola.
+ * @tparam T Tipo de dato de la matriz.
+ * @param matrix Matriz a mostrar.
+ */
+template <typename T>
+void display_matrix(const Tensor<T>& matrix) {
+    for (size_t i = 0; i < matrix.rows(); ++i) {
+        for (const auto& value : matrix[i]) {
+            std::cout << std::setw(5) << value << " ";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
 /**
  * Visualiza una imagen en la consola (por ejemplo, MNIST).
  * Los valores mayores a un umbral se muestran como '1', los demás como espacio.
  * @tparam T Tipo de dato del vector de la imagen.
- * @param image Imagen a visualizar (en formato vector).
+ * @param image Imagen a visualizar (por ejemplo, una fila de una Matrix).
  * @param rows Número de filas de la imagen.
  * @param columns Número de columnas de la imagen.
  */
 template <typename T>
-void display_image(const std::vector<T>& image, int rows, int columns) {
+void display_image(std::span<const T> image, int rows, int columns) {
     if (image.size() != static_cast<size_t>(rows * columns)) {
         throw std::invalid_argument("El tamaño de la imagen no coincide con las dimensiones proporcionadas.");
     }
 
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < columns; ++j) {
-            // Mostrar '1' si el valor supera un umbral, de lo contrario espacio
-            std::cout << (image[i * columns + j] > static_cast<T>(0.5) ? "1" : " ") << " ";
+            // Mostrar '1' si el valor supera la mitad del rango (0.5, o 127 con píxeles en bytes)
+            const T threshold = std::is_integral_v<T> ? static_cast<T>(127) : static_cast<T>(0.5);
+            std::cout << (image[i * columns + j] > threshold ? "1" : " ") << " ";
         }
         std::cout << std::endl;
     }
     std::cout << std::endl;
 }
 
+template <typename T>
+void display_image(const std::vector<T>& image, int rows, int columns) {
+    display_image(std::span<const T>(image), rows, columns);
+}
+
 /**
  * Muestra un vector en la consola (usado para depuración).
  * @tparam T Tipo de dato del vector.
@@ -0,0 +1,127 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "common.h"
+
+/**
+ * Memoria de trabajo de la propagación hacia adelante y hacia atrás.
+ * Se dimensiona a partir de la arquitectura y de un tamaño máximo de lote y se
+ * reutiliza en cada paso, de modo que el bucle de entrenamiento no reserva memoria
+ * una vez inicializado. Cada hilo que entrene necesita su propia instancia.
+ * @tparam T Tipo de dato del cálculo.
+ * @tparam Storage Tipo en que se guardan las activaciones ocultas del modo
+ *                 mini-batch que lee la retropropagación (por defecto T).
+ */
+template <typename T, typename Storage = T>
+struct Workspace {
+    std::vector<size_t> layer_sizes; // Neuronas por capa, incluida la entrada
+
+    // Modo por muestra
+    std::vector<Vector<T>> activations;           // Salida de cada capa
+    std::vector<std::vector<uint8_t>> relu_masks; // Máscara de ReLU por capa oculta
+    std::vector<Vector<T>> deltas;                // Gradiente respecto a z por capa
+    std::vector<size_t> nonzero_inputs;           // Índices de entradas no nulas (actualización dispersa)
+    std::vector<Vector<T>> quant_residuals;       // Derivadas de la cuantización simulada respecto a su escala
+
+    // Modo mini-batch: max_batch filas por capa; los lotes más cortos usan las primeras
+    size_t max_batch = 0;
+    Matrix<T> batch_inputs;                       // Lote de entrada convertido a T (entradas en bytes)
+    std::vector<Matrix<T>> batch_activations;
+    std::vector<Matrix<uint8_t>> batch_masks;
+    std::vector<Matrix<T>> batch_deltas;
+    std::vector<Matrix<Storage>> stored_activations; // Activaciones ocultas en Storage (vacío si Storage == T)
+    std::vector<Matrix<T>> batch_residuals;          // quant_residuals del lote (vacío sin cuantización simulada)
+
+    // Gradientes acumulados de los parámetros
+    std::vector<Matrix<T>> weight_gradients;
+    std::vector<Vector<T>> bias_gradients;
+    std::vector<T> scale_gradients;       // Gradiente de la escala de cada capa oculta (cuantización simulada)
+
+    bool quantized = false; // Si reserva los residuos de la cuantización simulada
+
+    Workspace() = default;
+
+    /**
+     * Reserva toda la memoria de trabajo.
+     * @param layer_sizes Neuronas por capa, empezando por la entrada.
+     * @param max_batch Tamaño máximo de lote que se va a procesar.
+     * @param quantized Si se entrena con cuantización simulada (reserva además sus residuos).
+     */
+    Workspace(std::vector<size_t> layer_sizes, size_t max_batch, bool quantized = false)
+        : layer_sizes(std::move(layer_sizes)), quantized(quantized) {
+        const size_t layers = this->layer_sizes.size() - 1;
+        for (size_t l = 0; l < layers; ++l) {
+            const size_t in = this->layer_sizes[l], out = this->layer_sizes[l + 1];
+            activations.emplace_back(out);
+            deltas.emplace_back(out);
+            if (l + 1 < layers) {
+                relu_masks.emplace_back(out);
+                if (quantized) quant_residuals.emplace_back(out);
+            }
+            weight_gradients.emplace_back(out, in);
+            bias_gradients.emplace_back(out);
+        }
+        nonzero_inputs.reserve(this->layer_sizes[0]);
+        scale_gradients.assign(layers - 1, static_cast<T>(0));
+        reserve_batch(max_batch);
+    }
+
+    /**
+     * Garantiza capacidad para lotes de hasta batch muestras. Solo reserva
+     * memoria si la capacidad actual no alcanza.
+     * @param batch Tamaño de lote requerido.
+     */
+    void reserve_batch(size_t batch) {
+        if (batch <= max_batch) return;
+        max_batch = batch;
+        batch_activations.clear();
+        batch_masks.clear();
+        batch_deltas.clear();
+        stored_activations.clear();
+        batch_residuals.clear();
+        batch_inputs = Matrix<T>(batch, layer_sizes[0]);
+        for (size_t l = 1; l < layer_sizes.size(); ++l) {
+            batch_activations.emplace_back(batch, layer_sizes[l]);
+            batch_deltas.emplace_back(batch, layer_sizes[l]);
+            if (l + 1 < layer_sizes.size()) {
+                batch_masks.emplace_back(batch, layer_sizes[l]);
+                if constexpr (!std::is_same_v<Storage, T>) stored_activations.emplace_back(batch, layer_sizes[l]);
+                if (quantized) batch_residuals.emplace_back(batch, layer_sizes[l]);
+            }
+        }
+    }
+};
+
+/**
+ * Memoria de trabajo de la inferencia de solo lectura (NeuralNetwork::infer y
+ * predict_batch). Dos buffers de batch filas del ancho de la mayor capa, que las
+ * capas usan alternadamente, y uno para convertir las entradas en bytes; no
+ * guarda máscaras ni gradientes. Cada hilo que infiera necesita el suyo.
+ * @tparam T Tipo de dato.
+ */
+template <typename T>
+struct InferenceScratch {
+    Vector<T> front;
+    Vector<T> back;
+    Vector<T> inputs; // Bloque de entrada convertido a T (entradas en bytes)
+    size_t width = 0; // Ancho de la mayor capa
+    size_t batch = 0; // Muestras por bloque que caben en cada buffer
+
+    InferenceScratch() = default;
+
+    /**
+     * @param layer_sizes Neuronas por capa, empezando por la entrada (que solo se copia si viene en bytes).
+     * @param batch Muestras que se propagan juntas en predict_batch.
+     */
+    explicit InferenceScratch(const std::vector<size_t>& layer_sizes, size_t batch = 1) : batch(batch) {
+        for (size_t l = 1; l < layer_sizes.size(); ++l) width = std::max(width, layer_sizes[l]);
+        front.resize(width * batch);
+        back.resize(width * batch);
+        inputs.resize(layer_sizes[0] * batch);
+    }
+};
+
+#endif // WORKSPACE_H
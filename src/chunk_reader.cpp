@@ -0,0 +1,395 @@
+#include "../include/chunk_reader.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define REDNEURONAL_HAS_PREAD 1
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define REDNEURONAL_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+    // Etiqueta de las lecturas síncronas de read
+    constexpr std::uint64_t SYNC_TAG = std::numeric_limits<std::uint64_t>::max();
+
+    // Tamaño máximo de cada petición al kernel (len de io_uring es de 32 bits)
+    constexpr std::size_t MAX_REQUEST = std::size_t{1} << 30;
+
+    // Hilos de E/S del mecanismo de respaldo: las lecturas esperan al disco, no a la CPU
+    constexpr std::size_t MAX_IO_THREADS = 4;
+}
+
+struct ChunkReader::State {
+    // Progreso de una lectura en vuelo
+    struct Request {
+        std::size_t offset = 0;
+        std::uint8_t* dst = nullptr;
+        std::size_t remaining = 0;
+        int error = 0;
+        bool done = false;
+    };
+
+    std::string path;
+    std::size_t length = 0;
+    std::size_t depth = 1;
+    std::unordered_map<std::uint64_t, Request> requests;
+    bool uring = false;
+
+#ifdef REDNEURONAL_HAS_PREAD
+    int fd = -1;
+#endif
+
+#ifdef REDNEURONAL_HAS_IO_URING
+    int ring_fd = -1;
+    void* sq_ring = nullptr;
+    void* cq_ring = nullptr;
+    std::size_t sq_ring_size = 0;
+    std::size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqes_size = 0;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+#endif
+
+    // Mecanismo de respaldo: cola de etiquetas pendientes y hilos que las leen
+    std::mutex mutex;
+    std::condition_variable pending;
+    std::condition_variable finished;
+    std::deque<std::uint64_t> queue;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    ~State() {
+        if (uring) {
+            drain_uring();
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            pending.notify_all();
+            for (auto& worker : workers) worker.join();
+        }
+#ifdef REDNEURONAL_HAS_IO_URING
+        if (sqes) ::munmap(sqes, sqes_size);
+        if (cq_ring && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_size);
+        if (sq_ring) ::munmap(sq_ring, sq_ring_size);
+        if (ring_fd >= 0) ::close(ring_fd);
+#endif
+#ifdef REDNEURONAL_HAS_PREAD
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    [[noreturn]] void fail(const std::string& what, int error) const {
+        throw std::runtime_error("Error: " + what + " " + path + " (" + std::strerror(error) + ").");
+    }
+
+    // ---- io_uring ----
+
+    // Crea los anillos; devuelve false si el kernel no admite io_uring o IORING_OP_READ
+    bool start_uring(std::size_t entries) {
+#ifdef REDNEURONAL_HAS_IO_URING
+        io_uring_params params{};
+        const long ring = ::syscall(__NR_io_uring_setup, static_cast<unsigned>(entries), &params);
+        if (ring < 0) return false;
+        ring_fd = static_cast<int>(ring);
+        // IORING_OP_READ llegó en Linux 5.6, la misma versión que IORING_FEAT_RW_CUR_POS
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) return false;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+        void* sq = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) return false;
+        sq_ring = sq;
+        if (single) {
+            cq_ring = sq_ring;
+        } else {
+            void* cq = ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                              IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) return false;
+            cq_ring = cq;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* entries_map = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                                   IORING_OFF_SQES);
+        if (entries_map == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(entries_map);
+
+        auto* sq_bytes = static_cast<std::uint8_t*>(sq_ring);
+        auto* cq_bytes = static_cast<std::uint8_t*>(cq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq_bytes + params.cq_off.cqes);
+        uring = true;
+        return true;
+#else
+        (void)entries;
+        return false;
+#endif
+    }
+
+    // Envía al kernel la parte pendiente de una lectura
+    void submit_uring(std::uint64_t tag, const Request& request) {
+#ifdef REDNEURONAL_HAS_IO_URING
+        // Somos el único productor: la cola se lee sin sincronizar y se publica con release
+        const unsigned tail = *sq_tail;
+        const unsigned index = tail & *sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.off = request.offset;
+        sqe.addr = reinterpret_cast<std::uint64_t>(request.dst);
+        sqe.len = static_cast<std::uint32_t>(std::min(request.remaining, MAX_REQUEST));
+        sqe.user_data = tag;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        while (::syscall(__NR_io_uring_enter, ring_fd, 1u, 0u, 0u, nullptr, std::size_t{0}) < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) fail("no se pudo encolar la lectura de", errno);
+        }
+#else
+        (void)tag;
+        (void)request;
+#endif
+    }
+
+    // Espera una finalización y la aplica a su lectura (reenviando el resto si fue corta)
+    void reap_uring() {
+#ifdef REDNEURONAL_HAS_IO_URING
+        const unsigned head = *cq_head;
+        while (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+            if (::syscall(__NR_io_uring_enter, ring_fd, 0u, 1u, static_cast<unsigned>(IORING_ENTER_GETEVENTS),
+                          nullptr, std::size_t{0}) < 0 && errno != EINTR) {
+                fail("no se pudo esperar la lectura de", errno);
+            }
+        }
+        const io_uring_cqe cqe = cqes[head & *cq_mask];
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+
+        Request& request = requests.at(cqe.user_data);
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            submit_uring(cqe.user_data, request);
+        } else if (cqe.res < 0) {
+            request.error = -cqe.res;
+            request.done = true;
+        } else if (cqe.res == 0) {
+            request.error = EIO; // Fin de archivo antes de tiempo
+            request.done = true;
+        } else {
+            const auto bytes = static_cast<std::size_t>(cqe.res);
+            request.offset += bytes;
+            request.dst += bytes;
+            request.remaining -= bytes;
+            if (request.remaining > 0) {
+                submit_uring(cqe.user_data, request);
+            } else {
+                request.done = true;
+            }
+        }
+#endif
+    }
+
+    // Espera a que el kernel termine todas las lecturas (los buffers dejan de usarse)
+    void drain_uring() noexcept {
+        try {
+            while (std::any_of(requests.begin(), requests.end(), [](const auto& r) { return !r.second.done; })) {
+                reap_uring();
+            }
+        } catch (...) {
+        }
+    }
+
+    // ---- Hilos de E/S ----
+
+    void start_threads() {
+        const std::size_t count = std::min(depth, MAX_IO_THREADS);
+        for (std::size_t i = 0; i < count; ++i) workers.emplace_back([this] { worker_loop(); });
+    }
+
+    void worker_loop() {
+#ifndef REDNEURONAL_HAS_PREAD
+        std::ifstream file(path, std::ios::binary); // Un flujo por hilo: la posición no se comparte
+#endif
+        while (true) {
+            std::uint64_t tag;
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                pending.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping) return;
+                tag = queue.front();
+                queue.pop_front();
+                request = requests.at(tag);
+            }
+            int error = 0;
+#ifdef REDNEURONAL_HAS_PREAD
+            while (request.remaining > 0) {
+                const ssize_t bytes = ::pread(fd, request.dst, std::min(request.remaining, MAX_REQUEST),
+                                              static_cast<off_t>(request.offset));
+                if (bytes < 0 && errno == EINTR) continue;
+                if (bytes <= 0) {
+                    error = bytes < 0 ? errno : EIO;
+                    break;
+                }
+                request.offset += static_cast<std::size_t>(bytes);
+                request.dst += bytes;
+                request.remaining -= static_cast<std::size_t>(bytes);
+            }
+#else
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(request.offset));
+            file.read(reinterpret_cast<char*>(request.dst), static_cast<std::streamsize>(request.remaining));
+            if (file.gcount() != static_cast<std::streamsize>(request.remaining)) error = EIO;
+#endif
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Request& stored = requests.at(tag);
+                stored.error = error;
+                stored.done = true;
+            }
+            finished.notify_all();
+        }
+    }
+};
+
+ChunkReader::ChunkReader(const std::string& path, std::size_t depth, ReadBackend backend)
+    : state(std::make_unique<State>()) {
+    state->path = path;
+    state->depth = std::max<std::size_t>(depth, 1);
+#ifdef REDNEURONAL_HAS_PREAD
+    state->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (state->fd < 0) {
+        throw std::runtime_error("Error: no se pudo abrir el archivo " + path);
+    }
+    struct stat info {};
+    if (::fstat(state->fd, &info) != 0) {
+        throw std::runtime_error("Error: no se pudo obtener el tamaño del archivo " + path);
+    }
+    state->length = static_cast<std::size_t>(info.st_size);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Error: no se pudo abrir el archivo " + path);
+    }
+    state->length = static_cast<std::size_t>(file.tellg());
+#endif
+
+    if (backend == ReadBackend::Auto) {
+        const char* forced = std::getenv("REDNEURONAL_IO");
+        backend = forced && std::strcmp(forced, "threads") == 0 ? ReadBackend::Threads : ReadBackend::IoUring;
+        if (backend == ReadBackend::IoUring && !state->start_uring(2 * (state->depth + 1))) {
+            backend = ReadBackend::Threads;
+        }
+    } else if (backend == ReadBackend::IoUring && !state->start_uring(2 * (state->depth + 1))) {
+        throw std::runtime_error("Error: io_uring no está disponible para leer el archivo " + path);
+    }
+    if (backend == ReadBackend::Threads) {
+        state->uring = false;
+        state->start_threads();
+    }
+}
+
+ChunkReader::~ChunkReader() = default;
+
+std::size_t ChunkReader::size() const { return state->length; }
+
+std::size_t ChunkReader::depth() const { return state->depth; }
+
+bool ChunkReader::uses_io_uring() const { return state->uring; }
+
+void ChunkReader::submit(std::size_t offset, std::span<std::uint8_t> dst, std::uint64_t tag) {
+    if (offset > state->length || dst.size() > state->length - offset) {
+        throw std::out_of_range("Error: la lectura se sale del archivo " + state->path);
+    }
+    State::Request request;
+    request.offset = offset;
+    request.dst = dst.data();
+    request.remaining = dst.size();
+    request.done = dst.empty();
+
+    if (state->uring) {
+        const std::size_t in_flight = state->requests.size() - state->requests.count(SYNC_TAG);
+        if (tag != SYNC_TAG && in_flight >= state->depth) {
+            throw std::runtime_error("Error: demasiadas lecturas en vuelo para el archivo " + state->path);
+        }
+        if (!state->requests.emplace(tag, request).second) {
+            throw std::runtime_error("Error: la etiqueta de lectura ya está en vuelo.");
+        }
+        if (!request.done) state->submit_uring(tag, request);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        const std::size_t in_flight = state->requests.size() - state->requests.count(SYNC_TAG);
+        if (tag != SYNC_TAG && in_flight >= state->depth) {
+            throw std::runtime_error("Error: demasiadas lecturas en vuelo para el archivo " + state->path);
+        }
+        if (!state->requests.emplace(tag, request).second) {
+            throw std::runtime_error("Error: la etiqueta de lectura ya está en vuelo.");
+        }
+        if (!request.done) state->queue.push_back(tag);
+    }
+    state->pending.notify_one();
+}
+
+void ChunkReader::wait(std::uint64_t tag) {
+    State::Request request;
+    if (state->uring) {
+        auto found = state->requests.find(tag);
+        if (found == state->requests.end()) {
+            throw std::runtime_error("Error: no hay ninguna lectura en vuelo con esa etiqueta.");
+        }
+        while (!found->second.done) state->reap_uring();
+        request = found->second;
+        state->requests.erase(found);
+    } else {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        auto found = state->requests.find(tag);
+        if (found == state->requests.end()) {
+            throw std::runtime_error("Error: no hay ninguna lectura en vuelo con esa etiqueta.");
+        }
+        state->finished.wait(lock, [&] { return found->second.done; });
+        request = found->second;
+        state->requests.erase(found);
+    }
+    if (request.error != 0) state->fail("falló la lectura del archivo", request.error);
+}
+
+void ChunkReader::read(std::size_t offset, std::span<std::uint8_t> dst) {
+    submit(offset, dst, SYNC_TAG);
+    wait(SYNC_TAG);
+}
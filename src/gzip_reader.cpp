@@ -0,0 +1,119 @@
+#include "../include/gzip_reader.h"
+#include "../include/mapped_file.h"
+#include <fstream>
+#include <limits>
+
+#ifdef REDNEURONAL_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    // Tamaño máximo de cada trozo entregado a zlib (avail_in y avail_out son de 32 bits)
+    constexpr std::size_t MAX_PIECE = std::size_t{1} << 30;
+
+    // Mayor razón de compresión de deflate (bloques de 258 bytes repetidos)
+    constexpr std::size_t MAX_RATIO = 1032;
+}
+
+struct GzipReader::State {
+    std::string path;
+    MappedFile file;          // Datos comprimidos, leídos desde las páginas del archivo
+    std::size_t consumed = 0; // Bytes comprimidos ya entregados a zlib
+    bool finished = false;
+#ifdef REDNEURONAL_HAS_ZLIB
+    z_stream stream{};
+    bool initialized = false;
+
+    ~State() {
+        if (initialized) inflateEnd(&stream);
+    }
+
+    [[noreturn]] void corrupt() const {
+        throw std::runtime_error("Error: el archivo " + path + " no es un gzip válido" +
+                                 (stream.msg ? std::string(" (") + stream.msg + ")" : std::string()) + ".");
+    }
+#endif
+};
+
+GzipReader::GzipReader(const std::string& path) : state(std::make_unique<State>()) {
+    state->path = path;
+#ifdef REDNEURONAL_HAS_ZLIB
+    state->file = MappedFile(path, AccessHint::Sequential);
+    // 15 + 32: ventana máxima y detección automática de la cabecera gzip o zlib
+    if (inflateInit2(&state->stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("Error: no se pudo iniciar la descompresión de " + path);
+    }
+    state->initialized = true;
+#else
+    throw std::runtime_error("Error: esta compilación no admite archivos comprimidos (falta zlib): " + path);
+#endif
+}
+
+GzipReader::~GzipReader() = default;
+
+bool GzipReader::is_gzip(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[2] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    return file.gcount() == 2 && magic[0] == 0x1F && magic[1] == 0x8B;
+}
+
+bool GzipReader::available() {
+#ifdef REDNEURONAL_HAS_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::size_t GzipReader::max_size() const {
+    const std::size_t compressed = state->file.bytes().size();
+    if (compressed > std::numeric_limits<std::size_t>::max() / MAX_RATIO) return std::numeric_limits<std::size_t>::max();
+    return compressed * MAX_RATIO;
+}
+
+std::size_t GzipReader::read(std::uint8_t* dst, std::size_t n) {
+    std::size_t produced = 0;
+#ifdef REDNEURONAL_HAS_ZLIB
+    State& s = *state;
+    const std::span<const std::uint8_t> input = s.file.bytes();
+    while (produced < n && !s.finished) {
+        if (s.stream.avail_in == 0) {
+            if (s.consumed == input.size()) {
+                // Sin más datos comprimidos en mitad de un miembro
+                throw std::runtime_error("Error: el archivo " + s.path + " está truncado.");
+            }
+            const std::size_t piece = std::min(input.size() - s.consumed, MAX_PIECE);
+            s.stream.next_in = const_cast<Bytef*>(input.data() + s.consumed);
+            s.stream.avail_in = static_cast<uInt>(piece);
+            s.consumed += piece;
+        }
+        const std::size_t room = std::min(n - produced, MAX_PIECE);
+        s.stream.next_out = dst + produced;
+        s.stream.avail_out = static_cast<uInt>(room);
+        const int status = inflate(&s.stream, Z_NO_FLUSH);
+        produced += room - s.stream.avail_out;
+
+        if (status == Z_STREAM_END) {
+            // Si quedan datos comprimidos, son otro miembro concatenado
+            if (s.stream.avail_in == 0 && s.consumed == input.size()) {
+                s.finished = true;
+            } else if (inflateReset(&s.stream) != Z_OK) {
+                s.corrupt();
+            }
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            s.corrupt();
+        }
+    }
+#else
+    (void)dst;
+    (void)n;
+#endif
+    return produced;
+}
+
+void GzipReader::read_exact(std::uint8_t* dst, std::size_t n) {
+    if (read(dst, n) != n) {
+        throw std::runtime_error("Error: el archivo " + state->path + " termina antes de lo esperado.");
+    }
+}
@@ -0,0 +1,237 @@
+#include "../include/kernels.h"
+#include "kernels_bf16.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace Kernels {
+
+#ifdef REDNEURONAL_X86_KERNELS
+    // Definidas en kernels_avx2.cpp y kernels_avx512.cpp
+    extern const KernelTable avx2_table;
+    extern const KernelTable avx512_table;
+
+    // Definidas en kernels_vnni.cpp: los kernels que cambian en la variante AVX512VNNI
+    // (el producto de 8 bits y los que necesitan vpshufb de 512 bits, de AVX512BW)
+    void gemm_u8s8_vnni(std::size_t m, std::size_t n, std::size_t k, const std::uint8_t* a, std::size_t lda,
+                        const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc);
+    void load_be16_avx512bw(const std::uint8_t* src, void* dst, std::size_t n);
+    void load_be32_avx512bw(const std::uint8_t* src, void* dst, std::size_t n);
+    void load_be64_avx512bw(const std::uint8_t* src, void* dst, std::size_t n);
+#endif
+
+    namespace {
+
+        // Implementación portable. Los acumuladores independientes permiten que el
+        // compilador vectorice con el conjunto base (SSE2 en x86-64) sin -ffast-math.
+        constexpr std::size_t LANES = 8;
+
+        template <typename T>
+        T generic_dot(const T* a, const T* b, std::size_t n) {
+            T acc[LANES] = {};
+            std::size_t i = 0;
+            for (; i + LANES <= n; i += LANES) {
+                for (std::size_t l = 0; l < LANES; ++l) acc[l] += a[i + l] * b[i + l];
+            }
+            T result = 0;
+            for (std::size_t l = 0; l < LANES; ++l) result += acc[l];
+            for (; i < n; ++i) result += a[i] * b[i];
+            return result;
+        }
+
+        template <typename T>
+        void generic_axpy(T alpha, const T* x, T* y, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+        }
+
+        template <typename T>
+        void generic_scale(T alpha, T* x, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) x[i] *= alpha;
+        }
+
+        template <typename T>
+        void generic_relu(const T* in, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) out[i] = in[i] > 0 ? in[i] : static_cast<T>(0);
+        }
+
+        template <typename T>
+        T generic_sum(const T* x, std::size_t n) {
+            T acc[LANES] = {};
+            std::size_t i = 0;
+            for (; i + LANES <= n; i += LANES) {
+                for (std::size_t l = 0; l < LANES; ++l) acc[l] += x[i + l];
+            }
+            T result = 0;
+            for (std::size_t l = 0; l < LANES; ++l) result += acc[l];
+            for (; i < n; ++i) result += x[i];
+            return result;
+        }
+
+        template <typename T>
+        T generic_max(const T* x, std::size_t n) {
+            T result = x[0];
+            for (std::size_t i = 1; i < n; ++i) result = x[i] > result ? x[i] : result;
+            return result;
+        }
+
+        template <typename T>
+        void generic_u8_to(const std::uint8_t* src, T* dst, std::size_t n, T scale) {
+            for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>(src[i]) * scale;
+        }
+
+        template <std::size_t Bytes>
+        void generic_load_be(const std::uint8_t* src, void* dst, std::size_t n) {
+            load_be_loop<Bytes>(src, static_cast<std::uint8_t*>(dst), n);
+        }
+
+        template <typename T>
+        T generic_abs_max(const T* x, std::size_t n) {
+            T result = 0;
+            for (std::size_t i = 0; i < n; ++i) result = std::max(result, std::abs(x[i]));
+            return result;
+        }
+
+        template <typename T>
+        void generic_fake_quant(const T* src, T* dst, T* residual, std::size_t n, T scale, T lo, T hi) {
+            const T inv_scale = static_cast<T>(1) / scale;
+            for (std::size_t i = 0; i < n; ++i) {
+                dst[i] = fake_quant_one(src[i], inv_scale, scale, lo, hi, residual ? residual + i : nullptr);
+            }
+        }
+
+        template <typename T>
+        void generic_row_backward(T a, T b, const T* x, T* w, T* acc, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const T weight = w[i];
+                acc[i] += a * weight;
+                w[i] = weight + b * x[i];
+            }
+        }
+
+        template <typename T>
+        void generic_gemm_micro(std::size_t kc, const T* a, const T* b, T* c) {
+            constexpr std::size_t NR = gemm_nr<T>;
+            T acc[GEMM_MR][NR] = {};
+            for (std::size_t p = 0; p < kc; ++p, a += GEMM_MR, b += NR) {
+                for (std::size_t r = 0; r < GEMM_MR; ++r) {
+                    for (std::size_t j = 0; j < NR; ++j) acc[r][j] += a[r] * b[j];
+                }
+            }
+            for (std::size_t r = 0; r < GEMM_MR; ++r) {
+                for (std::size_t j = 0; j < NR; ++j) c[r * NR + j] = acc[r][j];
+            }
+        }
+
+        void generic_bf16_from_f32(const float* src, std::uint16_t* dst, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) dst[i] = bf16_nearest(src[i]);
+        }
+
+        void generic_bf16_to_f32(const std::uint16_t* src, float* dst, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) dst[i] = bf16_to_float(src[i]);
+        }
+
+        void generic_gemm_u8s8(std::size_t m, std::size_t n, std::size_t k, const std::uint8_t* a, std::size_t lda,
+                               const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc) {
+            constexpr std::size_t NB = GEMM_S8_NB, KB = GEMM_S8_KB;
+            const std::size_t groups = (k + KB - 1) / KB;
+            for (std::size_t j0 = 0; j0 < n; j0 += NB) {
+                const std::int8_t* block = packed_b + j0 / NB * groups * NB * KB;
+                for (std::size_t i = 0; i < m; ++i) {
+                    const std::uint8_t* x = a + i * lda;
+                    std::int32_t acc[NB] = {};
+                    for (std::size_t g = 0; g < groups; ++g) {
+                        const std::int8_t* w = block + g * NB * KB;
+                        const std::size_t width = std::min(KB, k - g * KB);
+                        for (std::size_t j = 0; j < NB; ++j) {
+                            for (std::size_t q = 0; q < width; ++q) {
+                                acc[j] += static_cast<std::int32_t>(x[g * KB + q]) * w[j * KB + q];
+                            }
+                        }
+                    }
+                    for (std::size_t j = 0; j < std::min(NB, n - j0); ++j) c[i * ldc + j0 + j] = acc[j];
+                }
+            }
+        }
+
+        void generic_requantize_u8(const std::int32_t* acc, const float* multiplier, const float* offset,
+                                   std::uint8_t* dst, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) dst[i] = requantize_one(acc[i], multiplier[i], offset[i]);
+        }
+
+        const KernelTable generic_table = {
+                Isa::Generic,
+                generic_dot<float>, generic_dot<double>,
+                generic_axpy<float>, generic_axpy<double>,
+                generic_scale<float>, generic_scale<double>,
+                generic_relu<float>, generic_relu<double>,
+                generic_sum<float>, generic_sum<double>,
+                generic_max<float>, generic_max<double>,
+                generic_row_backward<float>, generic_row_backward<double>,
+                generic_gemm_micro<float>, generic_gemm_micro<double>,
+                generic_bf16_from_f32, bf16_stochastic_loop, generic_bf16_to_f32,
+                generic_gemm_u8s8, generic_requantize_u8,
+                generic_abs_max<float>, generic_abs_max<double>,
+                generic_fake_quant<float>, generic_fake_quant<double>,
+                generic_u8_to<float>, generic_u8_to<double>,
+                generic_load_be<2>, generic_load_be<4>, generic_load_be<8>,
+        };
+
+        // Mejor variante soportada por la CPU, sin tener en cuenta el entorno
+        Isa hardware_isa() {
+#if defined(REDNEURONAL_X86_KERNELS) && (defined(__GNUC__) || defined(__clang__))
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) return Isa::AVX512VNNI;
+            if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::AVX2;
+#endif
+            return Isa::Generic;
+        }
+    }
+
+    Isa detect_isa() {
+        Isa isa = hardware_isa();
+        if (const char* forced = std::getenv("REDNEURONAL_ISA")) {
+            Isa requested = isa;
+            if (std::strcmp(forced, "generic") == 0) requested = Isa::Generic;
+            else if (std::strcmp(forced, "avx2") == 0) requested = Isa::AVX2;
+            else if (std::strcmp(forced, "avx512") == 0) requested = Isa::AVX512;
+            else if (std::strcmp(forced, "avx512vnni") == 0) requested = Isa::AVX512VNNI;
+            isa = std::min(isa, requested);
+        }
+        return isa;
+    }
+
+    const KernelTable& table_for(Isa isa) {
+        isa = std::min(isa, hardware_isa());
+#ifdef REDNEURONAL_X86_KERNELS
+        if (isa == Isa::AVX512VNNI) {
+            // La tabla AVX-512 con el producto de 8 bits sobre vpdpbusd
+            static const KernelTable vnni_table = [] {
+                KernelTable table = avx512_table;
+                table.isa = Isa::AVX512VNNI;
+                table.gemm_u8s8 = gemm_u8s8_vnni;
+                table.load_be16 = load_be16_avx512bw;
+                table.load_be32 = load_be32_avx512bw;
+                table.load_be64 = load_be64_avx512bw;
+                return table;
+            }();
+            return vnni_table;
+        }
+        if (isa == Isa::AVX512) return avx512_table;
+        if (isa == Isa::AVX2) return avx2_table;
+#endif
+        return generic_table;
+    }
+
+    const char* isa_name(Isa isa) {
+        switch (isa) {
+            case Isa::AVX512VNNI: return "avx512vnni";
+            case Isa::AVX512: return "avx512";
+            case Isa::AVX2: return "avx2";
+            default: return "generic";
+        }
+    }
+
+    void select(Isa isa) {
+        active_slot() = &table_for(isa);
+    }
+}
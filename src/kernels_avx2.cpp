@@ -0,0 +1,548 @@
+// Variante AVX2 + FMA de los kernels. Este archivo se compila con -mavx2 -mfma
+// y solo se ejecuta si detect_isa() confirma soporte en la CPU.
+#include "../include/kernels.h"
+#include <immintrin.h>
+#include <cstring>
+#include "kernels_bf16.h"
+
+namespace Kernels {
+
+    namespace {
+
+        inline float hsum(__m256 v) {
+            __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+            lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+            return _mm_cvtss_f32(lo);
+        }
+
+        inline double hsum(__m256d v) {
+            __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            lo = _mm_add_sd(lo, _mm_unpackhi_pd(lo, lo));
+            return _mm_cvtsd_f64(lo);
+        }
+
+        float dot_f32(const float* a, const float* b, std::size_t n) {
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+                acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+                acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+            }
+            for (; i + 8 <= n; i += 8) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            }
+            float result = hsum(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+            for (; i < n; ++i) result += a[i] * b[i];
+            return result;
+        }
+
+        double dot_f64(const double* a, const double* b, std::size_t n) {
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+                acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+                acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), acc2);
+                acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), acc3);
+            }
+            for (; i + 4 <= n; i += 4) {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+            }
+            double result = hsum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+            for (; i < n; ++i) result += a[i] * b[i];
+            return result;
+        }
+
+        void axpy_f32(float alpha, const float* x, float* y, std::size_t n) {
+            const __m256 va = _mm256_set1_ps(alpha);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+            }
+            for (; i < n; ++i) y[i] += alpha * x[i];
+        }
+
+        void axpy_f64(double alpha, const double* x, double* y, std::size_t n) {
+            const __m256d va = _mm256_set1_pd(alpha);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+            }
+            for (; i < n; ++i) y[i] += alpha * x[i];
+        }
+
+        void scale_f32(float alpha, float* x, std::size_t n) {
+            const __m256 va = _mm256_set1_ps(alpha);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                _mm256_storeu_ps(x + i, _mm256_mul_ps(va, _mm256_loadu_ps(x + i)));
+            }
+            for (; i < n; ++i) x[i] *= alpha;
+        }
+
+        void scale_f64(double alpha, double* x, std::size_t n) {
+            const __m256d va = _mm256_set1_pd(alpha);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                _mm256_storeu_pd(x + i, _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+            }
+            for (; i < n; ++i) x[i] *= alpha;
+        }
+
+        void relu_f32(const float* in, float* out, std::size_t n) {
+            const __m256 zero = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_loadu_ps(in + i), zero));
+            }
+            for (; i < n; ++i) out[i] = in[i] > 0 ? in[i] : 0.0f;
+        }
+
+        void relu_f64(const double* in, double* out, std::size_t n) {
+            const __m256d zero = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                _mm256_storeu_pd(out + i, _mm256_max_pd(_mm256_loadu_pd(in + i), zero));
+            }
+            for (; i < n; ++i) out[i] = in[i] > 0 ? in[i] : 0.0;
+        }
+
+        float sum_f32(const float* x, std::size_t n) {
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+                acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(x + i + 8));
+            }
+            for (; i + 8 <= n; i += 8) acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+            float result = hsum(_mm256_add_ps(acc0, acc1));
+            for (; i < n; ++i) result += x[i];
+            return result;
+        }
+
+        double sum_f64(const double* x, std::size_t n) {
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+                acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x + i + 4));
+            }
+            for (; i + 4 <= n; i += 4) acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+            double result = hsum(_mm256_add_pd(acc0, acc1));
+            for (; i < n; ++i) result += x[i];
+            return result;
+        }
+
+        float max_f32(const float* x, std::size_t n) {
+            float result = x[0];
+            std::size_t i = 0;
+            if (n >= 8) {
+                __m256 acc = _mm256_loadu_ps(x);
+                for (i = 8; i + 8 <= n; i += 8) acc = _mm256_max_ps(acc, _mm256_loadu_ps(x + i));
+                alignas(32) float lanes[8];
+                _mm256_store_ps(lanes, acc);
+                for (float v : lanes) result = v > result ? v : result;
+            }
+            for (; i < n; ++i) result = x[i] > result ? x[i] : result;
+            return result;
+        }
+
+        double max_f64(const double* x, std::size_t n) {
+            double result = x[0];
+            std::size_t i = 0;
+            if (n >= 4) {
+                __m256d acc = _mm256_loadu_pd(x);
+                for (i = 4; i + 4 <= n; i += 4) acc = _mm256_max_pd(acc, _mm256_loadu_pd(x + i));
+                alignas(32) double lanes[4];
+                _mm256_store_pd(lanes, acc);
+                for (double v : lanes) result = v > result ? v : result;
+            }
+            for (; i < n; ++i) result = x[i] > result ? x[i] : result;
+            return result;
+        }
+
+        // 16 bytes por iteración, ampliados a int32 en dos mitades de 8
+        void u8_to_f32(const std::uint8_t* src, float* dst, std::size_t n, float scale) {
+            const __m256 vscale = _mm256_set1_ps(scale);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+                const __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_unpackhi_epi64(bytes, bytes)));
+                _mm256_storeu_ps(dst + i, _mm256_mul_ps(lo, vscale));
+                _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(hi, vscale));
+            }
+            for (; i < n; ++i) dst[i] = static_cast<float>(src[i]) * scale;
+        }
+
+        void u8_to_f64(const std::uint8_t* src, double* dst, std::size_t n, double scale) {
+            const __m256d vscale = _mm256_set1_pd(scale);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                std::uint64_t raw;
+                std::memcpy(&raw, src + i, sizeof(raw));
+                const __m256i words = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(raw)));
+                const __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(words));
+                const __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(words, 1));
+                _mm256_storeu_pd(dst + i, _mm256_mul_pd(lo, vscale));
+                _mm256_storeu_pd(dst + i + 4, _mm256_mul_pd(hi, vscale));
+            }
+            for (; i < n; ++i) dst[i] = static_cast<double>(src[i]) * scale;
+        }
+
+        float abs_max_f32(const float* x, std::size_t n) {
+            const __m256 sign = _mm256_set1_ps(-0.0f);
+            __m256 acc = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) acc = _mm256_max_ps(acc, _mm256_andnot_ps(sign, _mm256_loadu_ps(x + i)));
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, acc);
+            float result = 0;
+            for (float v : lanes) result = v > result ? v : result;
+            for (; i < n; ++i) result = std::max(result, std::abs(x[i]));
+            return result;
+        }
+
+        double abs_max_f64(const double* x, std::size_t n) {
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d acc = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) acc = _mm256_max_pd(acc, _mm256_andnot_pd(sign, _mm256_loadu_pd(x + i)));
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, acc);
+            double result = 0;
+            for (double v : lanes) result = v > result ? v : result;
+            for (; i < n; ++i) result = std::max(result, std::abs(x[i]));
+            return result;
+        }
+
+        // El residuo fuera de rango es el nivel saturado: r - (v si está en rango, 0 si no)
+        void fake_quant_f32(const float* src, float* dst, float* residual, std::size_t n, float scale, float lo,
+                            float hi) {
+            const float inv_scale = 1.0f / scale;
+            const __m256 vinv = _mm256_set1_ps(inv_scale), vscale = _mm256_set1_ps(scale);
+            const __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), vinv);
+                const __m256 r = _mm256_min_ps(_mm256_max_ps(
+                        _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC), vlo), vhi);
+                if (residual) {
+                    const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LE_OQ));
+                    _mm256_storeu_ps(residual + i, _mm256_sub_ps(r, _mm256_and_ps(inside, v)));
+                }
+                _mm256_storeu_ps(dst + i, _mm256_mul_ps(r, vscale));
+            }
+            for (; i < n; ++i) dst[i] = fake_quant_one(src[i], inv_scale, scale, lo, hi, residual ? residual + i : nullptr);
+        }
+
+        void fake_quant_f64(const double* src, double* dst, double* residual, std::size_t n, double scale, double lo,
+                            double hi) {
+            const double inv_scale = 1.0 / scale;
+            const __m256d vinv = _mm256_set1_pd(inv_scale), vscale = _mm256_set1_pd(scale);
+            const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d v = _mm256_mul_pd(_mm256_loadu_pd(src + i), vinv);
+                const __m256d r = _mm256_min_pd(_mm256_max_pd(
+                        _mm256_round_pd(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC), vlo), vhi);
+                if (residual) {
+                    const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(v, vlo, _CMP_GE_OQ), _mm256_cmp_pd(v, vhi, _CMP_LE_OQ));
+                    _mm256_storeu_pd(residual + i, _mm256_sub_pd(r, _mm256_and_pd(inside, v)));
+                }
+                _mm256_storeu_pd(dst + i, _mm256_mul_pd(r, vscale));
+            }
+            for (; i < n; ++i) dst[i] = fake_quant_one(src[i], inv_scale, scale, lo, hi, residual ? residual + i : nullptr);
+        }
+
+        void row_backward_f32(float a, float b, const float* x, float* w, float* acc, std::size_t n) {
+            const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m256 weight = _mm256_loadu_ps(w + i);
+                _mm256_storeu_ps(acc + i, _mm256_fmadd_ps(va, weight, _mm256_loadu_ps(acc + i)));
+                _mm256_storeu_ps(w + i, _mm256_fmadd_ps(vb, _mm256_loadu_ps(x + i), weight));
+            }
+            for (; i < n; ++i) {
+                const float weight = w[i];
+                acc[i] += a * weight;
+                w[i] = weight + b * x[i];
+            }
+        }
+
+        void row_backward_f64(double a, double b, const double* x, double* w, double* acc, std::size_t n) {
+            const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d weight = _mm256_loadu_pd(w + i);
+                _mm256_storeu_pd(acc + i, _mm256_fmadd_pd(va, weight, _mm256_loadu_pd(acc + i)));
+                _mm256_storeu_pd(w + i, _mm256_fmadd_pd(vb, _mm256_loadu_pd(x + i), weight));
+            }
+            for (; i < n; ++i) {
+                const double weight = w[i];
+                acc[i] += a * weight;
+                w[i] = weight + b * x[i];
+            }
+        }
+
+        // Bloque 4 x 16 floats: dos registros por fila, ocho acumuladores independientes
+        void gemm_micro_f32(std::size_t kc, const float* a, const float* b, float* c) {
+            __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+            __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+            __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+            __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+            for (std::size_t p = 0; p < kc; ++p, a += 4, b += 16) {
+                const __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+                __m256 ar = _mm256_broadcast_ss(a);
+                c00 = _mm256_fmadd_ps(ar, b0, c00); c01 = _mm256_fmadd_ps(ar, b1, c01);
+                ar = _mm256_broadcast_ss(a + 1);
+                c10 = _mm256_fmadd_ps(ar, b0, c10); c11 = _mm256_fmadd_ps(ar, b1, c11);
+                ar = _mm256_broadcast_ss(a + 2);
+                c20 = _mm256_fmadd_ps(ar, b0, c20); c21 = _mm256_fmadd_ps(ar, b1, c21);
+                ar = _mm256_broadcast_ss(a + 3);
+                c30 = _mm256_fmadd_ps(ar, b0, c30); c31 = _mm256_fmadd_ps(ar, b1, c31);
+            }
+            _mm256_storeu_ps(c, c00); _mm256_storeu_ps(c + 8, c01);
+            _mm256_storeu_ps(c + 16, c10); _mm256_storeu_ps(c + 24, c11);
+            _mm256_storeu_ps(c + 32, c20); _mm256_storeu_ps(c + 40, c21);
+            _mm256_storeu_ps(c + 48, c30); _mm256_storeu_ps(c + 56, c31);
+        }
+
+        // Bloque 4 x 8 doubles: dos registros por fila, ocho acumuladores independientes
+        void gemm_micro_f64(std::size_t kc, const double* a, const double* b, double* c) {
+            __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+            __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+            __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+            __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+            for (std::size_t p = 0; p < kc; ++p, a += 4, b += 8) {
+                const __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+                __m256d ar = _mm256_broadcast_sd(a);
+                c00 = _mm256_fmadd_pd(ar, b0, c00); c01 = _mm256_fmadd_pd(ar, b1, c01);
+                ar = _mm256_broadcast_sd(a + 1);
+                c10 = _mm256_fmadd_pd(ar, b0, c10); c11 = _mm256_fmadd_pd(ar, b1, c11);
+                ar = _mm256_broadcast_sd(a + 2);
+                c20 = _mm256_fmadd_pd(ar, b0, c20); c21 = _mm256_fmadd_pd(ar, b1, c21);
+                ar = _mm256_broadcast_sd(a + 3);
+                c30 = _mm256_fmadd_pd(ar, b0, c30); c31 = _mm256_fmadd_pd(ar, b1, c31);
+            }
+            _mm256_storeu_pd(c, c00); _mm256_storeu_pd(c + 4, c01);
+            _mm256_storeu_pd(c + 8, c10); _mm256_storeu_pd(c + 12, c11);
+            _mm256_storeu_pd(c + 16, c20); _mm256_storeu_pd(c + 20, c21);
+            _mm256_storeu_pd(c + 24, c30); _mm256_storeu_pd(c + 28, c31);
+        }
+
+        // 8 floats -> 8 bfloat16 con redondeo al par; los NaN se marcan como silenciosos
+        void bf16_from_f32(const float* src, std::uint16_t* dst, std::size_t n) {
+            const __m256i bias = _mm256_set1_epi32(0x7FFF), one = _mm256_set1_epi32(1);
+            const __m256i quiet = _mm256_set1_epi32(0x40);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m256 x = _mm256_loadu_ps(src + i);
+                const __m256i bits = _mm256_castps_si256(x);
+                const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+                __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(bias, lsb)), 16);
+                const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+                rounded = _mm256_blendv_epi8(rounded, _mm256_or_si256(_mm256_srli_epi32(bits, 16), quiet), nan);
+                // packus intercala por mitades de 128 bits: se reordenan antes de guardar
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rounded, rounded), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+            }
+            for (; i < n; ++i) dst[i] = bf16_nearest(src[i]);
+        }
+
+        // Mismo hash que rounding_noise, ocho posiciones a la vez
+        inline __m256i rounding_noise8(__m256i seed, __m256i index) {
+            __m256i h = _mm256_xor_si256(seed, _mm256_mullo_epi32(index, _mm256_set1_epi32(static_cast<int>(0x9E3779B9u))));
+            h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+            h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x7FEB352D));
+            h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+            h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x846CA68Bu)));
+            return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+        }
+
+        void bf16_from_f32_stochastic(const float* src, std::uint16_t* dst, std::size_t n, std::uint32_t seed) {
+            const __m256i vseed = _mm256_set1_epi32(static_cast<int>(seed));
+            const __m256i low = _mm256_set1_epi32(0xFFFF), quiet = _mm256_set1_epi32(0x40);
+            __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8, index = _mm256_add_epi32(index, _mm256_set1_epi32(8))) {
+                const __m256 x = _mm256_loadu_ps(src + i);
+                const __m256i bits = _mm256_castps_si256(x);
+                const __m256i noise = _mm256_and_si256(rounding_noise8(vseed, index), low);
+                __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, noise), 16);
+                const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+                rounded = _mm256_blendv_epi8(rounded, _mm256_or_si256(_mm256_srli_epi32(bits, 16), quiet), nan);
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rounded, rounded), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+            }
+            for (; i < n; ++i) dst[i] = bf16_stochastic(src[i], rounding_noise(seed, i));
+        }
+
+        void bf16_to_f32(const std::uint16_t* src, float* dst, std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+            }
+            for (; i < n; ++i) dst[i] = bf16_to_float(src[i]);
+        }
+
+        /**
+         * R muestras contra todas las neuronas, un bloque de 16 cada vez. Cada grupo
+         * de 4 valores de k se procesa en dos vectores de 8 neuronas: maddubs_epi16
+         * multiplica |x - 128| (sin signo, hasta 128) por el peso con el signo de
+         * x - 128 (hasta 127 en valor absoluto), así que cada par cabe en int16 sin
+         * saturar, y madd_epi16 con unos lo amplía a int32. Al guardar se suma
+         * 128 * (suma de los pesos de la neurona), que pack_u8s8 guarda tras los bloques.
+         */
+        template <std::size_t R>
+        void u8s8_rows(std::size_t n, std::size_t k, const std::uint8_t* x, std::size_t lda,
+                       const std::int8_t* packed_b, const std::int32_t* weight_sums, std::int32_t* c,
+                       std::size_t ldc) {
+            constexpr std::size_t NB = GEMM_S8_NB, KB = GEMM_S8_KB;
+            const std::size_t groups = (k + KB - 1) / KB, full = k / KB;
+            const __m256i ones = _mm256_set1_epi16(1);
+            for (std::size_t j0 = 0; j0 < n; j0 += NB) {
+                const std::int8_t* block = packed_b + j0 / NB * groups * NB * KB;
+                __m256i acc[R][2];
+                for (auto& row : acc) for (auto& v : row) v = _mm256_setzero_si256();
+                auto step = [&](const std::int8_t* w, const std::uint32_t (&bytes)[R]) {
+                    const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w));
+                    const __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + 32));
+                    for (std::size_t r = 0; r < R; ++r) {
+                        // x - 128 como int8 es x con el bit alto invertido
+                        const __m256i centered = _mm256_set1_epi32(static_cast<int>(bytes[r] ^ 0x80808080u));
+                        const __m256i magnitude = _mm256_abs_epi8(centered);
+                        const __m256i p0 = _mm256_maddubs_epi16(magnitude, _mm256_sign_epi8(w0, centered));
+                        const __m256i p1 = _mm256_maddubs_epi16(magnitude, _mm256_sign_epi8(w1, centered));
+                        acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(p0, ones));
+                        acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(p1, ones));
+                    }
+                };
+                for (std::size_t g = 0; g < full; ++g) {
+                    std::uint32_t bytes[R];
+                    for (std::size_t r = 0; r < R; ++r) std::memcpy(&bytes[r], x + r * lda + g * KB, KB);
+                    step(block + g * NB * KB, bytes);
+                }
+                if (groups > full) {
+                    // Cola de k: los pesos de relleno son cero, así que el relleno de x no importa
+                    std::uint32_t bytes[R] = {};
+                    for (std::size_t r = 0; r < R; ++r) std::memcpy(&bytes[r], x + r * lda + full * KB, k - full * KB);
+                    step(block + full * NB * KB, bytes);
+                }
+
+                const std::size_t cols = std::min(NB, n - j0);
+                for (std::size_t r = 0; r < R; ++r) {
+                    alignas(32) std::int32_t out[NB];
+                    for (std::size_t h = 0; h < 2; ++h) {
+                        const __m256i sums = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weight_sums + j0 + 8 * h));
+                        _mm256_store_si256(reinterpret_cast<__m256i*>(out + 8 * h),
+                                           _mm256_add_epi32(acc[r][h], _mm256_slli_epi32(sums, 7)));
+                    }
+                    std::copy_n(out, cols, c + r * ldc + j0);
+                }
+            }
+        }
+
+        // 8 acumuladores por iteración; packus deja los bytes 0-3 en cada mitad de 128 bits
+        void requantize_u8(const std::int32_t* acc, const float* multiplier, const float* offset, std::uint8_t* dst,
+                           std::size_t n) {
+            const __m256 zero = _mm256_setzero_ps(), top = _mm256_set1_ps(255.0f);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m256 value = _mm256_fmadd_ps(
+                        _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i))),
+                        _mm256_loadu_ps(multiplier + i), _mm256_loadu_ps(offset + i));
+                const __m256i q = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, zero), top));
+                const __m256i words = _mm256_packus_epi32(q, q);
+                const __m256i bytes = _mm256_packus_epi16(words, words);
+                const std::uint32_t low = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(bytes)));
+                const std::uint32_t high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm256_extracti128_si256(bytes, 1)));
+                std::memcpy(dst + i, &low, 4);
+                std::memcpy(dst + i + 4, &high, 4);
+            }
+            for (; i < n; ++i) dst[i] = requantize_one(acc[i], multiplier[i], offset[i]);
+        }
+    }
+
+    /**
+     * Producto de 8 bits en bloques de 4 muestras por 16 neuronas con
+     * maddubs_epi16 (ver u8s8_rows). Exige pesos en [-127, 127], los de la
+     * cuantización simétrica. Se exporta porque la tabla AVX-512 sin VNNI
+     * también la usa.
+     */
+    void gemm_u8s8_avx2(std::size_t m, std::size_t n, std::size_t k, const std::uint8_t* a, std::size_t lda,
+                        const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc) {
+        constexpr std::size_t NB = GEMM_S8_NB, KB = GEMM_S8_KB;
+        // pack_u8s8 deja la suma de los pesos de cada neurona tras los bloques
+        const std::int32_t* weight_sums = reinterpret_cast<const std::int32_t*>(
+                packed_b + (n + NB - 1) / NB * NB * ((k + KB - 1) / KB) * KB);
+        std::size_t i = 0;
+        for (; i + 4 <= m; i += 4) u8s8_rows<4>(n, k, a + i * lda, lda, packed_b, weight_sums, c + i * ldc, ldc);
+        const std::uint8_t* x = a + i * lda;
+        std::int32_t* out = c + i * ldc;
+        switch (m - i) {
+            case 3: u8s8_rows<3>(n, k, x, lda, packed_b, weight_sums, out, ldc); break;
+            case 2: u8s8_rows<2>(n, k, x, lda, packed_b, weight_sums, out, ldc); break;
+            case 1: u8s8_rows<1>(n, k, x, lda, packed_b, weight_sums, out, ldc); break;
+            default: break;
+        }
+    }
+
+    namespace {
+        // Máscara de vpshufb que invierte cada palabra de Bytes bytes (se repite en cada mitad de 128 bits)
+        template <std::size_t Bytes>
+        __m256i byte_reverse_mask() {
+            alignas(32) std::uint8_t order[32];
+            for (std::size_t p = 0; p < 32; ++p) {
+                const std::size_t lane = p % 16;
+                order[p] = static_cast<std::uint8_t>(lane - lane % Bytes + (Bytes - 1 - lane % Bytes));
+            }
+            return _mm256_load_si256(reinterpret_cast<const __m256i*>(order));
+        }
+
+        template <std::size_t Bytes>
+        void load_be(const std::uint8_t* src, void* dst, std::size_t n) {
+            auto* out = static_cast<std::uint8_t*>(dst);
+            const __m256i order = byte_reverse_mask<Bytes>();
+            const std::size_t total = n * Bytes;
+            std::size_t i = 0;
+            for (; i + 32 <= total; i += 32) {
+                const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(words, order));
+            }
+            load_be_loop<Bytes>(src + i, out + i, (total - i) / Bytes);
+        }
+    }
+
+    /**
+     * Lectura de palabras big-endian con vpshufb de 256 bits. Se exportan porque la
+     * tabla AVX-512 sin AVX512BW también las usa.
+     */
+    void load_be16_avx2(const std::uint8_t* src, void* dst, std::size_t n) { load_be<2>(src, dst, n); }
+    void load_be32_avx2(const std::uint8_t* src, void* dst, std::size_t n) { load_be<4>(src, dst, n); }
+    void load_be64_avx2(const std::uint8_t* src, void* dst, std::size_t n) { load_be<8>(src, dst, n); }
+
+    extern const KernelTable avx2_table = {
+            Isa::AVX2,
+            dot_f32, dot_f64,
+            axpy_f32, axpy_f64,
+            scale_f32, scale_f64,
+            relu_f32, relu_f64,
+            sum_f32, sum_f64,
+            max_f32, max_f64,
+            row_backward_f32, row_backward_f64,
+            gemm_micro_f32, gemm_micro_f64,
+            bf16_from_f32, bf16_from_f32_stochastic, bf16_to_f32,
+            gemm_u8s8_avx2, requantize_u8,
+            abs_max_f32, abs_max_f64,
+            fake_quant_f32, fake_quant_f64,
+            u8_to_f32, u8_to_f64,
+            load_be16_avx2, load_be32_avx2, load_be64_avx2,
+    };
+}
@@ -0,0 +1,447 @@
+// Variante AVX-512 de los kernels. Este archivo se compila con -mavx512f y
+// solo se ejecuta si detect_isa() confirma soporte en la CPU. Las colas se
+// procesan con cargas enmascaradas en lugar de un bucle escalar.
+#include "../include/kernels.h"
+#include <immintrin.h>
+#include "kernels_bf16.h"
+
+namespace Kernels {
+
+    // Definida en kernels_avx2.cpp: las operaciones de bytes de 512 bits necesitan
+    // AVX512BW, que esta variante no exige
+    void gemm_u8s8_avx2(std::size_t m, std::size_t n, std::size_t k, const std::uint8_t* a, std::size_t lda,
+                        const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc);
+    void load_be16_avx2(const std::uint8_t* src, void* dst, std::size_t n);
+    void load_be32_avx2(const std::uint8_t* src, void* dst, std::size_t n);
+    void load_be64_avx2(const std::uint8_t* src, void* dst, std::size_t n);
+
+    namespace {
+
+        inline __mmask16 tail_mask16(std::size_t remaining) {
+            return static_cast<__mmask16>((1u << remaining) - 1u);
+        }
+
+        inline __mmask8 tail_mask8(std::size_t remaining) {
+            return static_cast<__mmask8>((1u << remaining) - 1u);
+        }
+
+        float dot_f32(const float* a, const float* b, std::size_t n) {
+            __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+            __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 64 <= n; i += 64) {
+                acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+                acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+                acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), acc2);
+                acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), acc3);
+            }
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+            }
+            if (i < n) {
+                const __mmask16 m = tail_mask16(n - i);
+                acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), acc1);
+            }
+            return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+        }
+
+        double dot_f64(const double* a, const double* b, std::size_t n) {
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+                acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+                acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 16), _mm512_loadu_pd(b + i + 16), acc2);
+                acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 24), _mm512_loadu_pd(b + i + 24), acc3);
+            }
+            for (; i + 8 <= n; i += 8) {
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+            }
+            if (i < n) {
+                const __mmask8 m = tail_mask8(n - i);
+                acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + i), _mm512_maskz_loadu_pd(m, b + i), acc1);
+            }
+            return _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+        }
+
+        void axpy_f32(float alpha, const float* x, float* y, std::size_t n) {
+            const __m512 va = _mm512_set1_ps(alpha);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+            }
+            if (i < n) {
+                const __mmask16 m = tail_mask16(n - i);
+                _mm512_mask_storeu_ps(y + i, m, _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i),
+                                                                 _mm512_maskz_loadu_ps(m, y + i)));
+            }
+        }
+
+        void axpy_f64(double alpha, const double* x, double* y, std::size_t n) {
+            const __m512d va = _mm512_set1_pd(alpha);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+            }
+            if (i < n) {
+                const __mmask8 m = tail_mask8(n - i);
+                _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i),
+                                                                 _mm512_maskz_loadu_pd(m, y + i)));
+            }
+        }
+
+        void scale_f32(float alpha, float* x, std::size_t n) {
+            const __m512 va = _mm512_set1_ps(alpha);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) _mm512_storeu_ps(x + i, _mm512_mul_ps(va, _mm512_loadu_ps(x + i)));
+            if (i < n) {
+                const __mmask16 m = tail_mask16(n - i);
+                _mm512_mask_storeu_ps(x + i, m, _mm512_mul_ps(va, _mm512_maskz_loadu_ps(m, x + i)));
+            }
+        }
+
+        void scale_f64(double alpha, double* x, std::size_t n) {
+            const __m512d va = _mm512_set1_pd(alpha);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) _mm512_storeu_pd(x + i, _mm512_mul_pd(va, _mm512_loadu_pd(x + i)));
+            if (i < n) {
+                const __mmask8 m = tail_mask8(n - i);
+                _mm512_mask_storeu_pd(x + i, m, _mm512_mul_pd(va, _mm512_maskz_loadu_pd(m, x + i)));
+            }
+        }
+
+        void relu_f32(const float* in, float* out, std::size_t n) {
+            const __m512 zero = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_max_ps(_mm512_loadu_ps(in + i), zero));
+            if (i < n) {
+                const __mmask16 m = tail_mask16(n - i);
+                _mm512_mask_storeu_ps(out + i, m, _mm512_max_ps(_mm512_maskz_loadu_ps(m, in + i), zero));
+            }
+        }
+
+        void relu_f64(const double* in, double* out, std::size_t n) {
+            const __m512d zero = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_max_pd(_mm512_loadu_pd(in + i), zero));
+            if (i < n) {
+                const __mmask8 m = tail_mask8(n - i);
+                _mm512_mask_storeu_pd(out + i, m, _mm512_max_pd(_mm512_maskz_loadu_pd(m, in + i), zero));
+            }
+        }
+
+        float sum_f32(const float* x, std::size_t n) {
+            __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(x + i));
+                acc1 = _mm512_add_ps(acc1, _mm512_loadu_ps(x + i + 16));
+            }
+            for (; i + 16 <= n; i += 16) acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(x + i));
+            if (i < n) acc1 = _mm512_add_ps(acc1, _mm512_maskz_loadu_ps(tail_mask16(n - i), x + i));
+            return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+        }
+
+        double sum_f64(const double* x, std::size_t n) {
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(x + i));
+                acc1 = _mm512_add_pd(acc1, _mm512_loadu_pd(x + i + 8));
+            }
+            for (; i + 8 <= n; i += 8) acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(x + i));
+            if (i < n) acc1 = _mm512_add_pd(acc1, _mm512_maskz_loadu_pd(tail_mask8(n - i), x + i));
+            return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+        }
+
+        float max_f32(const float* x, std::size_t n) {
+            // Las posiciones fuera de la cola se rellenan con el primer elemento
+            __m512 acc = _mm512_set1_ps(x[0]);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) acc = _mm512_max_ps(acc, _mm512_loadu_ps(x + i));
+            if (i < n) acc = _mm512_max_ps(acc, _mm512_mask_loadu_ps(acc, tail_mask16(n - i), x + i));
+            return _mm512_reduce_max_ps(acc);
+        }
+
+        double max_f64(const double* x, std::size_t n) {
+            __m512d acc = _mm512_set1_pd(x[0]);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) acc = _mm512_max_pd(acc, _mm512_loadu_pd(x + i));
+            if (i < n) acc = _mm512_max_pd(acc, _mm512_mask_loadu_pd(acc, tail_mask8(n - i), x + i));
+            return _mm512_reduce_max_pd(acc);
+        }
+
+        // La cola va en escalar: cargar bytes con máscara requiere AVX-512BW
+        void u8_to_f32(const std::uint8_t* src, float* dst, std::size_t n, float scale) {
+            const __m512 vscale = _mm512_set1_ps(scale);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m512i words = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(words), vscale));
+            }
+            for (; i < n; ++i) dst[i] = static_cast<float>(src[i]) * scale;
+        }
+
+        void u8_to_f64(const std::uint8_t* src, double* dst, std::size_t n, double scale) {
+            const __m512d vscale = _mm512_set1_pd(scale);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                std::uint64_t raw;
+                std::memcpy(&raw, src + i, sizeof(raw));
+                const __m256i words = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(raw)));
+                _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_cvtepi32_pd(words), vscale));
+            }
+            for (; i < n; ++i) dst[i] = static_cast<double>(src[i]) * scale;
+        }
+
+        float abs_max_f32(const float* x, std::size_t n) {
+            __m512 acc = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) acc = _mm512_max_ps(acc, _mm512_abs_ps(_mm512_loadu_ps(x + i)));
+            if (i < n) acc = _mm512_max_ps(acc, _mm512_abs_ps(_mm512_maskz_loadu_ps(tail_mask16(n - i), x + i)));
+            return _mm512_reduce_max_ps(acc);
+        }
+
+        double abs_max_f64(const double* x, std::size_t n) {
+            __m512d acc = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) acc = _mm512_max_pd(acc, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+            if (i < n) acc = _mm512_max_pd(acc, _mm512_abs_pd(_mm512_maskz_loadu_pd(tail_mask8(n - i), x + i)));
+            return _mm512_reduce_max_pd(acc);
+        }
+
+        // Una iteración de fake_quant: la cola usa la misma ruta con carga y escrituras enmascaradas
+        inline void fake_quant16(const float* src, float* dst, float* residual, __mmask16 m, __m512 vinv,
+                                 __m512 vscale, __m512 vlo, __m512 vhi) {
+            const __m512 v = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, src), vinv);
+            const __m512 r = _mm512_min_ps(_mm512_max_ps(
+                    _mm512_roundscale_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC), vlo), vhi);
+            if (residual) {
+                const __mmask16 inside = _mm512_cmp_ps_mask(v, vlo, _CMP_GE_OQ) & _mm512_cmp_ps_mask(v, vhi, _CMP_LE_OQ);
+                _mm512_mask_storeu_ps(residual, m, _mm512_mask_sub_ps(r, inside, r, v));
+            }
+            _mm512_mask_storeu_ps(dst, m, _mm512_mul_ps(r, vscale));
+        }
+
+        inline void fake_quant8(const double* src, double* dst, double* residual, __mmask8 m, __m512d vinv,
+                                __m512d vscale, __m512d vlo, __m512d vhi) {
+            const __m512d v = _mm512_mul_pd(_mm512_maskz_loadu_pd(m, src), vinv);
+            const __m512d r = _mm512_min_pd(_mm512_max_pd(
+                    _mm512_roundscale_pd(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC), vlo), vhi);
+            if (residual) {
+                const __mmask8 inside = _mm512_cmp_pd_mask(v, vlo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(v, vhi, _CMP_LE_OQ);
+                _mm512_mask_storeu_pd(residual, m, _mm512_mask_sub_pd(r, inside, r, v));
+            }
+            _mm512_mask_storeu_pd(dst, m, _mm512_mul_pd(r, vscale));
+        }
+
+        void fake_quant_f32(const float* src, float* dst, float* residual, std::size_t n, float scale, float lo,
+                            float hi) {
+            const __m512 vinv = _mm512_set1_ps(1.0f / scale), vscale = _mm512_set1_ps(scale);
+            const __m512 vlo = _mm512_set1_ps(lo), vhi = _mm512_set1_ps(hi);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                fake_quant16(src + i, dst + i, residual ? residual + i : nullptr, 0xFFFF, vinv, vscale, vlo, vhi);
+            }
+            if (i < n) {
+                fake_quant16(src + i, dst + i, residual ? residual + i : nullptr, tail_mask16(n - i), vinv, vscale,
+                             vlo, vhi);
+            }
+        }
+
+        void fake_quant_f64(const double* src, double* dst, double* residual, std::size_t n, double scale, double lo,
+                            double hi) {
+            const __m512d vinv = _mm512_set1_pd(1.0 / scale), vscale = _mm512_set1_pd(scale);
+            const __m512d vlo = _mm512_set1_pd(lo), vhi = _mm512_set1_pd(hi);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                fake_quant8(src + i, dst + i, residual ? residual + i : nullptr, 0xFF, vinv, vscale, vlo, vhi);
+            }
+            if (i < n) {
+                fake_quant8(src + i, dst + i, residual ? residual + i : nullptr, tail_mask8(n - i), vinv, vscale,
+                            vlo, vhi);
+            }
+        }
+
+        void row_backward_f32(float a, float b, const float* x, float* w, float* acc, std::size_t n) {
+            const __m512 va = _mm512_set1_ps(a), vb = _mm512_set1_ps(b);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m512 weight = _mm512_loadu_ps(w + i);
+                _mm512_storeu_ps(acc + i, _mm512_fmadd_ps(va, weight, _mm512_loadu_ps(acc + i)));
+                _mm512_storeu_ps(w + i, _mm512_fmadd_ps(vb, _mm512_loadu_ps(x + i), weight));
+            }
+            if (i < n) {
+                const __mmask16 m = tail_mask16(n - i);
+                const __m512 weight = _mm512_maskz_loadu_ps(m, w + i);
+                _mm512_mask_storeu_ps(acc + i, m, _mm512_fmadd_ps(va, weight, _mm512_maskz_loadu_ps(m, acc + i)));
+                _mm512_mask_storeu_ps(w + i, m, _mm512_fmadd_ps(vb, _mm512_maskz_loadu_ps(m, x + i), weight));
+            }
+        }
+
+        void row_backward_f64(double a, double b, const double* x, double* w, double* acc, std::size_t n) {
+            const __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m512d weight = _mm512_loadu_pd(w + i);
+                _mm512_storeu_pd(acc + i, _mm512_fmadd_pd(va, weight, _mm512_loadu_pd(acc + i)));
+                _mm512_storeu_pd(w + i, _mm512_fmadd_pd(vb, _mm512_loadu_pd(x + i), weight));
+            }
+            if (i < n) {
+                const __mmask8 m = tail_mask8(n - i);
+                const __m512d weight = _mm512_maskz_loadu_pd(m, w + i);
+                _mm512_mask_storeu_pd(acc + i, m, _mm512_fmadd_pd(va, weight, _mm512_maskz_loadu_pd(m, acc + i)));
+                _mm512_mask_storeu_pd(w + i, m, _mm512_fmadd_pd(vb, _mm512_maskz_loadu_pd(m, x + i), weight));
+            }
+        }
+
+        // Bloque 4 x 16 floats: un registro por fila. Se alternan dos juegos de
+        // acumuladores entre pasos de k para tener ocho FMA independientes en vuelo
+        void gemm_micro_f32(std::size_t kc, const float* a, const float* b, float* c) {
+            __m512 c0 = _mm512_setzero_ps(), c1 = _mm512_setzero_ps();
+            __m512 c2 = _mm512_setzero_ps(), c3 = _mm512_setzero_ps();
+            __m512 d0 = _mm512_setzero_ps(), d1 = _mm512_setzero_ps();
+            __m512 d2 = _mm512_setzero_ps(), d3 = _mm512_setzero_ps();
+            std::size_t p = 0;
+            for (; p + 2 <= kc; p += 2, a += 8, b += 32) {
+                const __m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+                c0 = _mm512_fmadd_ps(_mm512_set1_ps(a[0]), b0, c0);
+                c1 = _mm512_fmadd_ps(_mm512_set1_ps(a[1]), b0, c1);
+                c2 = _mm512_fmadd_ps(_mm512_set1_ps(a[2]), b0, c2);
+                c3 = _mm512_fmadd_ps(_mm512_set1_ps(a[3]), b0, c3);
+                d0 = _mm512_fmadd_ps(_mm512_set1_ps(a[4]), b1, d0);
+                d1 = _mm512_fmadd_ps(_mm512_set1_ps(a[5]), b1, d1);
+                d2 = _mm512_fmadd_ps(_mm512_set1_ps(a[6]), b1, d2);
+                d3 = _mm512_fmadd_ps(_mm512_set1_ps(a[7]), b1, d3);
+            }
+            if (p < kc) {
+                const __m512 b0 = _mm512_loadu_ps(b);
+                c0 = _mm512_fmadd_ps(_mm512_set1_ps(a[0]), b0, c0);
+                c1 = _mm512_fmadd_ps(_mm512_set1_ps(a[1]), b0, c1);
+                c2 = _mm512_fmadd_ps(_mm512_set1_ps(a[2]), b0, c2);
+                c3 = _mm512_fmadd_ps(_mm512_set1_ps(a[3]), b0, c3);
+            }
+            _mm512_storeu_ps(c, _mm512_add_ps(c0, d0));
+            _mm512_storeu_ps(c + 16, _mm512_add_ps(c1, d1));
+            _mm512_storeu_ps(c + 32, _mm512_add_ps(c2, d2));
+            _mm512_storeu_ps(c + 48, _mm512_add_ps(c3, d3));
+        }
+
+        // Bloque 4 x 8 doubles con el mismo esquema de dos juegos de acumuladores
+        void gemm_micro_f64(std::size_t kc, const double* a, const double* b, double* c) {
+            __m512d c0 = _mm512_setzero_pd(), c1 = _mm512_setzero_pd();
+            __m512d c2 = _mm512_setzero_pd(), c3 = _mm512_setzero_pd();
+            __m512d d0 = _mm512_setzero_pd(), d1 = _mm512_setzero_pd();
+            __m512d d2 = _mm512_setzero_pd(), d3 = _mm512_setzero_pd();
+            std::size_t p = 0;
+            for (; p + 2 <= kc; p += 2, a += 8, b += 16) {
+                const __m512d b0 = _mm512_loadu_pd(b), b1 = _mm512_loadu_pd(b + 8);
+                c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[0]), b0, c0);
+                c1 = _mm512_fmadd_pd(_mm512_set1_pd(a[1]), b0, c1);
+                c2 = _mm512_fmadd_pd(_mm512_set1_pd(a[2]), b0, c2);
+                c3 = _mm512_fmadd_pd(_mm512_set1_pd(a[3]), b0, c3);
+                d0 = _mm512_fmadd_pd(_mm512_set1_pd(a[4]), b1, d0);
+                d1 = _mm512_fmadd_pd(_mm512_set1_pd(a[5]), b1, d1);
+                d2 = _mm512_fmadd_pd(_mm512_set1_pd(a[6]), b1, d2);
+                d3 = _mm512_fmadd_pd(_mm512_set1_pd(a[7]), b1, d3);
+            }
+            if (p < kc) {
+                const __m512d b0 = _mm512_loadu_pd(b);
+                c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[0]), b0, c0);
+                c1 = _mm512_fmadd_pd(_mm512_set1_pd(a[1]), b0, c1);
+                c2 = _mm512_fmadd_pd(_mm512_set1_pd(a[2]), b0, c2);
+                c3 = _mm512_fmadd_pd(_mm512_set1_pd(a[3]), b0, c3);
+            }
+            _mm512_storeu_pd(c, _mm512_add_pd(c0, d0));
+            _mm512_storeu_pd(c + 8, _mm512_add_pd(c1, d1));
+            _mm512_storeu_pd(c + 16, _mm512_add_pd(c2, d2));
+            _mm512_storeu_pd(c + 24, _mm512_add_pd(c3, d3));
+        }
+
+        // 16 floats -> 16 bfloat16 con redondeo al par; los NaN se marcan como silenciosos
+        void bf16_from_f32(const float* src, std::uint16_t* dst, std::size_t n) {
+            const __m512i bias = _mm512_set1_epi32(0x7FFF), one = _mm512_set1_epi32(1);
+            const __m512i quiet = _mm512_set1_epi32(0x40);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m512 x = _mm512_loadu_ps(src + i);
+                const __m512i bits = _mm512_castps_si512(x);
+                const __m512i high = _mm512_srli_epi32(bits, 16);
+                const __m512i lsb = _mm512_and_si512(high, one);
+                __m512i rounded = _mm512_srli_epi32(_mm512_add_epi32(bits, _mm512_add_epi32(bias, lsb)), 16);
+                const __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+                rounded = _mm512_mask_mov_epi32(rounded, nan, _mm512_or_si512(high, quiet));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvtepi32_epi16(rounded));
+            }
+            for (; i < n; ++i) dst[i] = bf16_nearest(src[i]);
+        }
+
+        // Mismo hash que rounding_noise, dieciséis posiciones a la vez
+        inline __m512i rounding_noise16(__m512i seed, __m512i index) {
+            __m512i h = _mm512_xor_si512(seed, _mm512_mullo_epi32(index, _mm512_set1_epi32(static_cast<int>(0x9E3779B9u))));
+            h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+            h = _mm512_mullo_epi32(h, _mm512_set1_epi32(0x7FEB352D));
+            h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+            h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(0x846CA68Bu)));
+            return _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+        }
+
+        void bf16_from_f32_stochastic(const float* src, std::uint16_t* dst, std::size_t n, std::uint32_t seed) {
+            const __m512i vseed = _mm512_set1_epi32(static_cast<int>(seed));
+            const __m512i low = _mm512_set1_epi32(0xFFFF), quiet = _mm512_set1_epi32(0x40);
+            __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16, index = _mm512_add_epi32(index, _mm512_set1_epi32(16))) {
+                const __m512 x = _mm512_loadu_ps(src + i);
+                const __m512i bits = _mm512_castps_si512(x);
+                const __m512i noise = _mm512_and_si512(rounding_noise16(vseed, index), low);
+                __m512i rounded = _mm512_srli_epi32(_mm512_add_epi32(bits, noise), 16);
+                const __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+                rounded = _mm512_mask_mov_epi32(rounded, nan, _mm512_or_si512(_mm512_srli_epi32(bits, 16), quiet));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvtepi32_epi16(rounded));
+            }
+            for (; i < n; ++i) dst[i] = bf16_stochastic(src[i], rounding_noise(seed, i));
+        }
+
+        void bf16_to_f32(const std::uint16_t* src, float* dst, std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+                _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(_mm512_slli_epi32(wide, 16)));
+            }
+            for (; i < n; ++i) dst[i] = bf16_to_float(src[i]);
+        }
+
+        void requantize_u8(const std::int32_t* acc, const float* multiplier, const float* offset, std::uint8_t* dst,
+                           std::size_t n) {
+            const __m512 zero = _mm512_setzero_ps(), top = _mm512_set1_ps(255.0f);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m512 value = _mm512_fmadd_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(acc + i)),
+                                                     _mm512_loadu_ps(multiplier + i), _mm512_loadu_ps(offset + i));
+                const __m512i q = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(value, zero), top));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm512_cvtepi32_epi8(q));
+            }
+            for (; i < n; ++i) dst[i] = requantize_one(acc[i], multiplier[i], offset[i]);
+        }
+    }
+
+    extern const KernelTable avx512_table = {
+            Isa::AVX512,
+            dot_f32, dot_f64,
+            axpy_f32, axpy_f64,
+            scale_f32, scale_f64,
+            relu_f32, relu_f64,
+            sum_f32, sum_f64,
+            max_f32, max_f64,
+            row_backward_f32, row_backward_f64,
+            gemm_micro_f32, gemm_micro_f64,
+            bf16_from_f32, bf16_from_f32_stochastic, bf16_to_f32,
+            gemm_u8s8_avx2, requantize_u8,
+            abs_max_f32, abs_max_f64,
+            fake_quant_f32, fake_quant_f64,
+            u8_to_f32, u8_to_f64,
+            load_be16_avx2, load_be32_avx2, load_be64_avx2,
+    };
+}
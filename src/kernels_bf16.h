@@ -0,0 +1,103 @@
+// Conversiones escalares (float <-> bfloat16, recuantización a uint8, cuantización simulada
+// y lectura de enteros big-endian)
+// compartidas por las variantes de los kernels. Va en un espacio de nombres anónimo a propósito: cada unidad de
+// traducción se compila con otras opciones (-mavx2, -mavx512f) y una función
+// inline común podría acabar enlazada en su versión AVX-512 también para la
+// variante portable.
+#ifndef KERNELS_BF16_H
+#define KERNELS_BF16_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+namespace Kernels {
+    namespace {
+
+        inline std::uint32_t float_bits(float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        inline bool is_nan_bits(std::uint32_t bits) { return (bits & 0x7FFFFFFFu) > 0x7F800000u; }
+
+        // Redondeo al par más cercano; los NaN se truncan marcados como silenciosos
+        inline std::uint16_t bf16_nearest(float value) {
+            const std::uint32_t bits = float_bits(value);
+            if (is_nan_bits(bits)) return static_cast<std::uint16_t>((bits >> 16) | 0x40u);
+            return static_cast<std::uint16_t>((bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16);
+        }
+
+        // Ruido de 32 bits en función de la semilla y la posición (hash lowbias32)
+        inline std::uint32_t rounding_noise(std::uint32_t seed, std::size_t i) {
+            std::uint32_t h = seed ^ (static_cast<std::uint32_t>(i) * 0x9E3779B9u);
+            h ^= h >> 16;
+            h *= 0x7FEB352Du;
+            h ^= h >> 15;
+            h *= 0x846CA68Bu;
+            h ^= h >> 16;
+            return h;
+        }
+
+        // Redondeo estocástico: ruido uniforme en los 16 bits que se descartan
+        inline std::uint16_t bf16_stochastic(float value, std::uint32_t noise) {
+            const std::uint32_t bits = float_bits(value);
+            if (is_nan_bits(bits)) return static_cast<std::uint16_t>((bits >> 16) | 0x40u);
+            return static_cast<std::uint16_t>((bits + (noise & 0xFFFFu)) >> 16);
+        }
+
+        inline float bf16_to_float(std::uint16_t value) {
+            const std::uint32_t bits = static_cast<std::uint32_t>(value) << 16;
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        // Recuantización escalar (colas de las variantes SIMD): lrint redondea al par como cvtps
+        inline std::uint8_t requantize_one(std::int32_t acc, float multiplier, float offset) {
+            const float value = static_cast<float>(acc) * multiplier + offset;
+            return static_cast<std::uint8_t>(std::lrint(std::min(std::max(value, 0.0f), 255.0f)));
+        }
+
+        /**
+         * Cuantización simulada de un valor: lo lleva a la rejilla scale * [lo, hi]
+         * con redondeo al par (nearbyint, como cvtps y roundscale). Si residual no es
+         * nulo guarda la derivada del resultado respecto a scale (en unidades de
+         * scale): round(v) - v dentro del rango y el extremo fuera de él.
+         */
+        template <typename T>
+        inline T fake_quant_one(T x, T inv_scale, T scale, T lo, T hi, T* residual) {
+            const T v = x * inv_scale;
+            const T r = std::min(std::max(std::nearbyint(v), lo), hi);
+            if (residual) *residual = (v >= lo && v <= hi) ? r - v : r;
+            return r * scale;
+        }
+
+        /**
+         * Lee n palabras big-endian de Bytes bytes (sin alinear) y copia sus bits en
+         * el orden del host; sirve para enteros, float y double. Componer con
+         * desplazamientos no depende del orden del host y el compilador lo reduce a bswap.
+         */
+        template <std::size_t Bytes>
+        inline void load_be_loop(const std::uint8_t* src, std::uint8_t* dst, std::size_t n) {
+            using Word = std::conditional_t<Bytes == 2, std::uint16_t,
+                                            std::conditional_t<Bytes == 4, std::uint32_t, std::uint64_t>>;
+            for (std::size_t i = 0; i < n; ++i) {
+                Word value = 0;
+                for (std::size_t b = 0; b < Bytes; ++b) value = static_cast<Word>((value << 8) | src[i * Bytes + b]);
+                std::memcpy(dst + i * Bytes, &value, Bytes);
+            }
+        }
+
+        // Versión portable del redondeo estocástico (las variantes SIMD usan el mismo ruido)
+        inline void bf16_stochastic_loop(const float* src, std::uint16_t* dst, std::size_t n, std::uint32_t seed) {
+            for (std::size_t i = 0; i < n; ++i) dst[i] = bf16_stochastic(src[i], rounding_noise(seed, i));
+        }
+    }
+}
+
+#endif // KERNELS_BF16_H
@@ -0,0 +1,125 @@
+// Producto de 8 bits con AVX-512 VNNI y operaciones de bytes de 512 bits. Este
+// archivo se compila con -mavx512f -mavx512bw -mavx512vnni y solo se ejecuta si
+// detect_isa() confirma soporte en la CPU; el resto de kernels de esa variante
+// son los de AVX-512.
+#include "../include/kernels.h"
+#include <immintrin.h>
+#include <cstring>
+
+namespace Kernels {
+
+    namespace {
+
+        constexpr std::size_t ROWS = 4; // Muestras por micro-bloque
+
+        /**
+         * Micro-bloque de R muestras por NV bloques de 16 neuronas: por cada grupo
+         * de 4 valores de k se cargan NV vectores de pesos, se difunden los 4 bytes
+         * de cada muestra y vpdpbusd acumula directamente en int32 (sin saturación
+         * ni reducciones horizontales).
+         */
+        template <std::size_t R, std::size_t NV>
+        void vnni_block(const std::uint8_t* x, std::size_t lda, const std::int8_t* w, std::size_t block_stride,
+                        std::size_t k, std::int32_t* c, std::size_t ldc, std::size_t cols) {
+            constexpr std::size_t NB = GEMM_S8_NB, KB = GEMM_S8_KB;
+            const std::size_t full = k / KB;
+            __m512i acc[R][NV];
+            for (auto& row : acc) for (auto& v : row) v = _mm512_setzero_si512();
+
+            // Los 4 bytes de cada muestra se difunden directamente desde memoria
+            auto step = [&](const std::uint8_t* bytes, std::size_t ld, std::size_t g) {
+                __m512i wv[NV];
+                for (std::size_t v = 0; v < NV; ++v) wv[v] = _mm512_loadu_si512(w + v * block_stride + g * NB * KB);
+                for (std::size_t r = 0; r < R; ++r) {
+                    std::int32_t group;
+                    std::memcpy(&group, bytes + r * ld, KB);
+                    const __m512i xb = _mm512_set1_epi32(group);
+                    for (std::size_t v = 0; v < NV; ++v) acc[r][v] = _mm512_dpbusd_epi32(acc[r][v], xb, wv[v]);
+                }
+            };
+            for (std::size_t g = 0; g < full; ++g) step(x + g * KB, lda, g);
+            if (k % KB) {
+                // Cola de k: los bytes que quedan, completados con ceros
+                std::uint8_t tail[R][KB] = {};
+                for (std::size_t r = 0; r < R; ++r) std::memcpy(tail[r], x + r * lda + full * KB, k % KB);
+                step(&tail[0][0], KB, full);
+            }
+
+            for (std::size_t r = 0; r < R; ++r) {
+                for (std::size_t v = 0; v < NV; ++v) {
+                    const std::size_t valid = cols > v * NB ? std::min(NB, cols - v * NB) : 0;
+                    const __mmask16 mask = static_cast<__mmask16>((1u << valid) - 1u);
+                    _mm512_mask_storeu_epi32(c + r * ldc + v * NB, mask, acc[r][v]);
+                }
+            }
+        }
+
+        // R muestras contra todas las neuronas, en tramos de hasta 4 bloques de 16
+        template <std::size_t R>
+        void vnni_rows(std::size_t n, std::size_t k, const std::uint8_t* x, std::size_t lda,
+                       const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc) {
+            constexpr std::size_t NB = GEMM_S8_NB, KB = GEMM_S8_KB, NV = 4;
+            const std::size_t block_stride = (k + KB - 1) / KB * NB * KB;
+            const std::size_t blocks = (n + NB - 1) / NB;
+            for (std::size_t b0 = 0; b0 < blocks; b0 += NV) {
+                const std::size_t j0 = b0 * NB, cols = std::min(NV * NB, n - j0);
+                const std::int8_t* w = packed_b + b0 * block_stride;
+                switch (std::min(NV, blocks - b0)) {
+                    case 4: vnni_block<R, 4>(x, lda, w, block_stride, k, c + j0, ldc, cols); break;
+                    case 3: vnni_block<R, 3>(x, lda, w, block_stride, k, c + j0, ldc, cols); break;
+                    case 2: vnni_block<R, 2>(x, lda, w, block_stride, k, c + j0, ldc, cols); break;
+                    default: vnni_block<R, 1>(x, lda, w, block_stride, k, c + j0, ldc, cols); break;
+                }
+            }
+        }
+    }
+
+    void gemm_u8s8_vnni(std::size_t m, std::size_t n, std::size_t k, const std::uint8_t* a, std::size_t lda,
+                        const std::int8_t* packed_b, std::int32_t* c, std::size_t ldc) {
+        std::size_t i = 0;
+        for (; i + ROWS <= m; i += ROWS) vnni_rows<ROWS>(n, k, a + i * lda, lda, packed_b, c + i * ldc, ldc);
+        // Las filas que sobran van en un micro-bloque de su tamaño justo
+        const std::uint8_t* x = a + i * lda;
+        std::int32_t* out = c + i * ldc;
+        switch (m - i) {
+            case 3: vnni_rows<3>(n, k, x, lda, packed_b, out, ldc); break;
+            case 2: vnni_rows<2>(n, k, x, lda, packed_b, out, ldc); break;
+            case 1: vnni_rows<1>(n, k, x, lda, packed_b, out, ldc); break;
+            default: break;
+        }
+    }
+
+    namespace {
+        // Máscara de vpshufb que invierte cada palabra de Bytes bytes (se repite en cada bloque de 128 bits)
+        template <std::size_t Bytes>
+        __m512i byte_reverse_mask() {
+            alignas(64) std::uint8_t order[64];
+            for (std::size_t p = 0; p < 64; ++p) {
+                const std::size_t lane = p % 16;
+                order[p] = static_cast<std::uint8_t>(lane - lane % Bytes + (Bytes - 1 - lane % Bytes));
+            }
+            return _mm512_load_si512(order);
+        }
+
+        // La cola usa cargas y escrituras enmascaradas por bytes (AVX512BW)
+        template <std::size_t Bytes>
+        void load_be(const std::uint8_t* src, void* dst, std::size_t n) {
+            auto* out = static_cast<std::uint8_t*>(dst);
+            const __m512i order = byte_reverse_mask<Bytes>();
+            const std::size_t total = n * Bytes;
+            std::size_t i = 0;
+            for (; i + 64 <= total; i += 64) {
+                _mm512_storeu_si512(out + i, _mm512_shuffle_epi8(_mm512_loadu_si512(src + i), order));
+            }
+            if (i < total) {
+                const __mmask64 mask = (std::uint64_t{1} << (total - i)) - 1;
+                const __m512i words = _mm512_maskz_loadu_epi8(mask, src + i);
+                _mm512_mask_storeu_epi8(out + i, mask, _mm512_shuffle_epi8(words, order));
+            }
+        }
+    }
+
+    void load_be16_avx512bw(const std::uint8_t* src, void* dst, std::size_t n) { load_be<2>(src, dst, n); }
+    void load_be32_avx512bw(const std::uint8_t* src, void* dst, std::size_t n) { load_be<4>(src, dst, n); }
+    void load_be64_avx512bw(const std::uint8_t* src, void* dst, std::size_t n) { load_be<8>(src, dst, n); }
+}
@@ -0,0 +1,103 @@
+#include "../include/mapped_file.h"
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define REDNEURONAL_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef REDNEURONAL_HAS_MMAP
+namespace {
+    int advice_for(AccessHint hint) {
+        switch (hint) {
+            case AccessHint::Random: return MADV_RANDOM;
+            case AccessHint::WillNeed: return MADV_WILLNEED;
+            default: return MADV_SEQUENTIAL;
+        }
+    }
+}
+#endif
+
+MappedFile::MappedFile(const std::string& path, AccessHint hint) {
+#ifdef REDNEURONAL_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Error: no se pudo abrir el archivo " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Error: no se pudo obtener el tamaño del archivo " + path);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Error: no se pudo mapear en memoria el archivo " + path);
+        }
+        data = static_cast<const std::uint8_t*>(address);
+        mapped = true;
+    }
+    ::close(fd); // El mapeo sigue siendo válido sin el descriptor
+    advise(hint);
+#else
+    (void)hint;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Error: no se pudo abrir el archivo " + path);
+    }
+    fallback.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fallback.data()), static_cast<std::streamsize>(fallback.size()));
+    if (file.gcount() != static_cast<std::streamsize>(fallback.size())) {
+        throw std::runtime_error("Error: no se pudo leer completo el archivo " + path);
+    }
+    data = fallback.data();
+    length = fallback.size();
+#endif
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        fallback = std::move(other.fallback);
+        data = other.mapped ? other.data : fallback.data();
+        length = other.length;
+        mapped = other.mapped;
+        other.data = nullptr;
+        other.length = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+void MappedFile::advise(AccessHint hint) const {
+#ifdef REDNEURONAL_HAS_MMAP
+    if (mapped) {
+        // Solo es un consejo: si el kernel no lo admite, el mapeo funciona igual
+        ::madvise(const_cast<std::uint8_t*>(data), length, advice_for(hint));
+    }
+#else
+    (void)hint;
+#endif
+}
+
+void MappedFile::release() noexcept {
+#ifdef REDNEURONAL_HAS_MMAP
+    if (mapped) ::munmap(const_cast<std::uint8_t*>(data), length);
+#endif
+    fallback.clear();
+    data = nullptr;
+    length = 0;
+    mapped = false;
+}
@@ -0,0 +1,176 @@
+#include "../include/thread_pool.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    // Pool y posición del trabajador que ejecuta el hilo actual (nullptr fuera de un pool)
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local std::size_t current_index = 0;
+
+    // Posiciones de los hilos externos, compartidas por todos los pools: cada hilo
+    // toma la menor libre la primera vez que la necesita y la devuelve al terminar
+    std::mutex external_mutex;
+    std::vector<std::size_t> free_external;
+    std::size_t next_external = 0;
+
+    struct ExternalIndex {
+        std::size_t value;
+
+        ExternalIndex() {
+            std::lock_guard<std::mutex> lock(external_mutex);
+            if (free_external.empty()) {
+                value = next_external++;
+            } else {
+                const auto lowest = std::min_element(free_external.begin(), free_external.end());
+                value = *lowest;
+                free_external.erase(lowest);
+            }
+        }
+
+        ~ExternalIndex() {
+            std::lock_guard<std::mutex> lock(external_mutex);
+            free_external.push_back(value);
+        }
+    };
+
+    thread_local ExternalIndex external_index;
+
+    // Fija el hilo actual a un núcleo; en plataformas sin soporte no hace nada
+    void pin_current_thread(std::size_t core) {
+        const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        core %= cores;
+#if defined(_WIN32)
+        if (core < 8 * sizeof(DWORD_PTR)) {
+            SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core);
+        }
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)core;
+#endif
+    }
+}
+
+ThreadPool::ThreadPool(std::size_t threads, bool pin) {
+    threads = std::max<std::size_t>(threads, 1);
+    for (std::size_t i = 0; i < threads; ++i) queues.push_back(std::make_unique<Queue>());
+    for (std::size_t i = 0; i + 1 < threads; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i, pin);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+std::size_t ThreadPool::slot() const {
+    return current_pool == this ? current_index : queues.size() - 1 + external_index.value;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    Queue& queue = *queues[std::min(slot(), queues.size() - 1)];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1, std::memory_order_release);
+    // Tomar el mutex evita perder el aviso si un trabajador está a punto de dormirse
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    wake.notify_one();
+}
+
+bool ThreadPool::take_task(std::size_t index, std::function<void()>& task) {
+    if (pending.load(std::memory_order_acquire) == 0) return false;
+
+    // Primero la cola propia por el final, después robar por el principio de las demás
+    for (std::size_t k = 0; k < queues.size(); ++k) {
+        Queue& queue = *queues[(index + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (k == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::run_one() {
+    std::function<void()> task;
+    if (!take_task(std::min(slot(), queues.size() - 1), task)) return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(std::size_t index, bool pin) {
+    current_pool = this;
+    current_index = index;
+    if (pin) pin_current_thread(index + 1);
+
+    std::function<void()> task;
+    while (true) {
+        if (take_task(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+        if (stopping && pending.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+SpinTeam::SpinTeam(std::size_t threads, bool pin) : barrier(std::max<std::size_t>(threads, 1)) {
+    for (std::size_t i = 1; i < threads; ++i) {
+        helpers.emplace_back(&SpinTeam::helper_loop, this, i, pin);
+    }
+}
+
+SpinTeam::~SpinTeam() {
+    stopping.store(true, std::memory_order_release);
+    epoch.fetch_add(1, std::memory_order_release);
+    for (auto& helper : helpers) helper.join();
+}
+
+void SpinTeam::helper_loop(std::size_t index, bool pin) {
+    if (pin) pin_current_thread(index);
+
+    std::size_t seen = 0;
+    unsigned spins = 0;
+    while (true) {
+        const std::size_t current = epoch.load(std::memory_order_acquire);
+        if (current != seen) {
+            seen = current;
+            if (stopping.load(std::memory_order_acquire)) return;
+            job(job_context, index);
+            finished.fetch_add(1, std::memory_order_release);
+            spins = 0;
+        } else if (++spins < SPIN_LIMIT) {
+            spin_pause();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}